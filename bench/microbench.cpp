@@ -0,0 +1,482 @@
+/**
+ * @file microbench.cpp
+ * @brief   Microbenchmarks for the hot kernels of the move generator, the board and the tables.
+ *          Every kernel runs over a corpus of positions collected by random games from a few
+ *          well known starting points, so the inputs look like the ones perft sees.
+ *          A sample repeats a pass over the corpus until it takes at least MIN_SAMPLE_NS,
+ *          the fastest of SAMPLES samples is reported as ns/op and, on x86, as TSC ticks/op.
+ *
+ *          usage: slou_microbench [filter]     only runs kernels whose name contains 'filter'
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "board/board.h"
+#include "config.h"
+#include "eval.h"
+#include "move_generator/move_generation.h"
+#include "perft/simd_leaves.h"
+#include "ttable.h"
+#include "zobrist.h"
+
+namespace {
+    constexpr int SAMPLES = 5;
+    constexpr double MIN_SAMPLE_NS = 20e6;
+    constexpr int CORPUS_GAMES = 64;
+    constexpr int CORPUS_PLIES = 48;
+
+    /**
+     * @brief   Forces the compiler to materialize value, so the computation behind it can not
+     *          be removed as dead code. Does not cost anything beyond keeping the value alive.
+     */
+    template <typename T>
+    inline void doNotOptimize(const T& value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    // every store before this is assumed to be observed, so writes to the board are not dropped either
+    inline void clobberMemory()
+    {
+        asm volatile("" : : : "memory");
+    }
+
+    inline uint64_t readTsc()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return 0ULL;
+#endif
+    }
+
+    constexpr bool HAS_TSC =
+#if defined(__x86_64__) || defined(__i386__)
+        true;
+#else
+        false;
+#endif
+
+    struct Measurement {
+        std::string name;
+        size_t ops = 0;         // ops per pass
+        double ns = 0.0;        // per op
+        double ticks = 0.0;     // tsc ticks per op
+    };
+
+    static std::string filter = "";
+    static std::vector<Measurement> measurements;
+
+    /**
+     * @brief   Times pass(), which has to do 'ops' operations, and records the fastest sample.
+     */
+    template <typename Pass>
+    void measure(const std::string& name, size_t ops, Pass&& pass)
+    {
+        if ( (!filter.empty() && name.find(filter) == std::string::npos) || ops == 0 ) {
+            return;
+        }
+
+        // double the passes per sample until one sample is long enough for the clock
+        size_t passes = 1;
+        while ( true ) {
+            const auto begin = std::chrono::steady_clock::now();
+            for ( size_t i = 0; i < passes; ++i ) {
+                pass();
+            }
+            const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+            if ( ns >= MIN_SAMPLE_NS ) {
+                break;
+            }
+            passes *= 2;
+        }
+
+        Measurement result { name, ops, 0.0, 0.0 };
+        for ( int sample = 0; sample < SAMPLES; ++sample ) {
+            const auto begin = std::chrono::steady_clock::now();
+            const uint64_t tsc_begin = readTsc();
+            for ( size_t i = 0; i < passes; ++i ) {
+                pass();
+            }
+            const uint64_t tsc_end = readTsc();
+            const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+
+            const double total_ops = static_cast<double>(passes) * ops;
+            if ( sample == 0 || ns / total_ops < result.ns ) {
+                result.ns = ns / total_ops;
+                result.ticks = (tsc_end - tsc_begin) / total_ops;
+            }
+        }
+
+        std::cout << std::left << std::setw(40) << result.name
+            << std::setw(10) << result.ops
+            << std::setw(12) << std::fixed << std::setprecision(2) << result.ns;
+        if ( HAS_TSC ) {
+            std::cout << std::setprecision(1) << result.ticks;
+        }
+        else {
+            std::cout << "n/a";
+        }
+        std::cout << std::endl;
+
+        measurements.push_back(result);
+    }
+
+    template <Color color>
+    void playRandomGame(Board board, int plies, std::mt19937_64& rng, std::vector<Board>& corpus)
+    {
+        if ( plies == 0 ) {
+            return;
+        }
+
+        MoveList list;
+        generate_moves<color>(list, board);
+        if ( list.size() == 0 ) {
+            return;
+        }
+
+        board.move<color>(list[rng() % list.size()]);
+        corpus.push_back(board);
+        playRandomGame<utils::switchColor(color)>(board, plies - 1, rng, corpus);
+    }
+
+    /**
+     * @brief   Positions of random games from the usual perft positions, with a fixed seed
+     *          so every run and every build measures the same inputs.
+     */
+    std::vector<Board> buildCorpus()
+    {
+        const std::array<std::string, 4> fens = {
+            "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+            "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        };
+
+        std::mt19937_64 rng(0x736c6f75ULL);
+        std::vector<Board> corpus;
+        for ( int game = 0; game < CORPUS_GAMES; ++game ) {
+            Board board(fens[game % fens.size()]);
+            corpus.push_back(board);
+            if ( board.whiteTurn() ) {
+                playRandomGame<Color::white>(board, CORPUS_PLIES, rng, corpus);
+            }
+            else {
+                playRandomGame<Color::black>(board, CORPUS_PLIES, rng, corpus);
+            }
+        }
+
+        return corpus;
+    }
+
+    template <Color color>
+    uint64_t enemyAttacks(const Board& board)
+    {
+        return generate_attacks<utils::switchColor(color)>(board);
+    }
+
+    // runs kernel<color> with the color to move of board
+#define DISPATCH_COLOR(board, kernel, ...) \
+    ((board).whiteTurn() ? kernel<Color::white>(__VA_ARGS__) : kernel<Color::black>(__VA_ARGS__))
+
+    template <PieceType type>
+    void benchSquareMagic(const std::vector<Board>& corpus, const std::string& name)
+    {
+        // (occupancy, square) of every slider that moves like 'type'
+        std::vector<std::pair<uint64_t, int>> inputs;
+        for ( const auto& board : corpus ) {
+            uint64_t pieces = board.getPieces<type, Color::white>() | board.getPieces<type, Color::black>()
+                | board.getPieces<PieceType::queen, Color::white>() | board.getPieces<PieceType::queen, Color::black>();
+            BIT_LOOP(pieces)
+            {
+                inputs.emplace_back(board.getOccupancy(), get_LSB(pieces));
+            }
+        }
+
+        measure(name, inputs.size(), [&inputs] {
+            for ( const auto& [occupancy, square] : inputs ) {
+                doNotOptimize(sliders::getSquareMagic<type>(occupancy, square));
+            }
+        });
+    }
+
+    template <Color color>
+    void pawnMoves(MoveList& list, const Board& board) { leapers::pawn<color>(list, board); }
+
+    template <Color color>
+    void knightMoves(MoveList& list, const Board& board) { leapers::knight<color>(list, board); }
+
+    template <Color color>
+    void kingMoves(MoveList& list, const Board& board, uint64_t enemy_attacks) { leapers::king<color>(list, board, enemy_attacks); }
+
+    template <Color color>
+    void legalMoves(MoveList& list, Board& board) { generate_moves<color>(list, board); }
+
+    void benchMoveGeneration(std::vector<Board>& corpus)
+    {
+        std::vector<uint64_t> enemy_attacks;
+        for ( const auto& board : corpus ) {
+            enemy_attacks.push_back(DISPATCH_COLOR(board, enemyAttacks, board));
+        }
+
+        MoveList list;
+        measure("leapers::pawn", corpus.size(), [&] {
+            for ( const auto& board : corpus ) {
+                list.clear();
+                DISPATCH_COLOR(board, pawnMoves, list, board);
+                doNotOptimize(list);
+            }
+        });
+
+        measure("leapers::knight", corpus.size(), [&] {
+            for ( const auto& board : corpus ) {
+                list.clear();
+                DISPATCH_COLOR(board, knightMoves, list, board);
+                doNotOptimize(list);
+            }
+        });
+
+        measure("leapers::king", corpus.size(), [&] {
+            for ( size_t i = 0; i < corpus.size(); ++i ) {
+                list.clear();
+                DISPATCH_COLOR(corpus[i], kingMoves, list, corpus[i], enemy_attacks[i]);
+                doNotOptimize(list);
+            }
+        });
+
+        measure("generate_attacks", corpus.size(), [&] {
+            for ( const auto& board : corpus ) {
+                doNotOptimize(DISPATCH_COLOR(board, enemyAttacks, board));
+            }
+        });
+
+        // for reference, everything above together plus the legality check
+        measure("generate_moves (legal)", corpus.size(), [&] {
+            for ( auto& board : corpus ) {
+                list.clear();
+                DISPATCH_COLOR(board, legalMoves, list, board);
+                doNotOptimize(list);
+            }
+        });
+    }
+
+    template <Color color>
+    void moveUndo(Board& board, const Move& move)
+    {
+        board.move<color>(move);
+        clobberMemory();
+        board.undo<color>(move);
+    }
+
+    void benchMoveUndo(std::vector<Board>& corpus)
+    {
+        struct Sample {
+            Board* board;
+            Move move;
+        };
+
+        const std::array<std::string, 7> names = { "quiet", "pawn_push", "castle", "capture", "ep", "promo", "promo_capture" };
+        std::array<std::vector<Sample>, 7> samples;
+
+        for ( auto& board : corpus ) {
+            MoveList list;
+            DISPATCH_COLOR(board, legalMoves, list, board);
+            for ( const auto& move : list ) {
+                size_t group = 0;
+                if ( move.isPromoCapture() ) group = 6;
+                else if ( move.isPromotion() ) group = 5;
+                else if ( move.isEnpassant() ) group = 4;
+                else if ( move.isCapture() ) group = 3;
+                else if ( move.isKingCastle() || move.isQueenCastle() ) group = 2;
+                else if ( move.isDoublePawnPush() ) group = 1;
+
+                samples[group].push_back(Sample { &board, move });
+            }
+        }
+
+        for ( size_t group = 0; group < samples.size(); ++group ) {
+            measure("Board::move+undo " + names[group], samples[group].size(), [&samples, group] {
+                for ( const auto& sample : samples[group] ) {
+                    DISPATCH_COLOR(*sample.board, moveUndo, *sample.board, sample.move);
+                }
+            });
+        }
+    }
+
+    void benchZobrist(const std::vector<Board>& corpus)
+    {
+        std::mt19937_64 rng(1);
+        std::vector<std::pair<int, int>> toggles(1 << 16);
+        for ( auto& [piece, square] : toggles ) {
+            piece = rng() % kNumPieces;
+            square = rng() % kNumSquares;
+        }
+
+        measure("Zobrist::togglePiece", toggles.size(), [&toggles] {
+            uint64_t hash = 0ULL;
+            for ( const auto& [piece, square] : toggles ) {
+                Zobrist::togglePiece(hash, piece, square);
+                doNotOptimize(hash);
+            }
+        });
+
+        measure("Zobrist::computeHash", corpus.size(), [&corpus] {
+            for ( const auto& board : corpus ) {
+                doNotOptimize(Zobrist::computeHash(board));
+            }
+        });
+    }
+
+    /**
+     * @brief   Probes and stores of random keys. With more keys than the table has buckets
+     *          this mostly measures the cache miss, which is what perft pays for a table lookup.
+     */
+    template <size_t MB>
+    void benchTable(const std::vector<uint64_t>& keys)
+    {
+        auto table = std::make_unique<TTable<TTEntry_perft, MB>>();
+        const std::string size = std::to_string(MB) + "MB";
+
+        measure("TTable::store " + size, keys.size(), [&keys, &table] {
+            int depth = 1;
+            for ( const uint64_t key : keys ) {
+                table->store(key, depth, key >> 40);
+                depth = (depth & 7) + 1;
+            }
+            clobberMemory();
+        });
+
+        measure("TTable::if_has_get " + size, keys.size(), [&keys, &table] {
+            int depth = 1;
+            for ( const uint64_t key : keys ) {
+                uint64_t nodes = 0;
+                doNotOptimize(table->if_has_get(key, depth, nodes));
+                doNotOptimize(nodes);
+                depth = (depth & 7) + 1;
+            }
+        });
+    }
+
+    template <Color color>
+    uint64_t countLeaves(const std::vector<Board*>& boards)
+    {
+        uint64_t nodes = 0ULL;
+        simd_leaves::Batch batch;
+        for ( const Board* board : boards ) {
+            batch.add<color>(*board);
+            if ( batch.full() ) {
+                nodes += simd_leaves::count<color>(batch);
+                batch.clear();
+            }
+        }
+
+        return batch.empty() ? nodes : nodes + simd_leaves::count<color>(batch);
+    }
+
+    /**
+     * @brief   The vectorized leaf counter against the legal move generator it replaces at the
+     *          last ply of perft. Checks that both agree on every position before timing them.
+     *
+     * @return false if a position is counted differently
+     */
+    bool benchLeafCount(std::vector<Board>& corpus)
+    {
+        std::array<std::vector<Board*>, 2> by_color;
+        for ( auto& board : corpus ) {
+            by_color[board.whiteTurn() ? 0 : 1].push_back(&board);
+
+            MoveList list;
+            DISPATCH_COLOR(board, legalMoves, list, board);
+
+            simd_leaves::Batch batch;
+            const uint64_t nodes = board.whiteTurn() ? (batch.add<Color::white>(board), simd_leaves::count<Color::white>(batch))
+                                                     : (batch.add<Color::black>(board), simd_leaves::count<Color::black>(batch));
+            if ( nodes != list.size() ) {
+                std::cout << RED << "simd_leaves counts " << nodes << " moves instead of " << list.size() << " in " << board.getFen() << RESET << '\n';
+                return false;
+            }
+        }
+
+        MoveList list;
+        measure("leaf count generate_moves", corpus.size(), [&] {
+            for ( auto& board : corpus ) {
+                list.clear();
+                DISPATCH_COLOR(board, legalMoves, list, board);
+                doNotOptimize(list.size());
+            }
+        });
+
+        measure("leaf count simd_leaves x" + std::to_string(simd_leaves::LANES), corpus.size(), [&by_color] {
+            doNotOptimize(countLeaves<Color::white>(by_color[0]));
+            doNotOptimize(countLeaves<Color::black>(by_color[1]));
+        });
+
+        return true;
+    }
+
+    template <Color color>
+    Score evaluate(Board& board) { return evalPosition<color>(board); }
+
+    void benchEval(std::vector<Board>& corpus)
+    {
+        measure("evalPosition", corpus.size(), [&corpus] {
+            for ( auto& board : corpus ) {
+                doNotOptimize(DISPATCH_COLOR(board, evaluate, board));
+            }
+        });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if ( argc > 2 ) {
+        std::cout << "usage: slou_microbench [filter]\n";
+        return 1;
+    }
+
+    filter = (argc == 2) ? argv[1] : "";
+    initializePrecomputedStuff();
+
+    std::vector<Board> corpus = buildCorpus();
+
+    std::mt19937_64 rng(2);
+    std::vector<uint64_t> keys(1 << 20);
+    for ( auto& key : keys ) {
+        key = rng();
+    }
+
+    std::cout << corpus.size() << " positions, fastest of " << SAMPLES << " samples"
+        << (HAS_TSC ? ", ticks are TSC reference cycles" : "") << '\n'
+        << THIN_LINE << '\n'
+        << std::left << std::setw(40) << "kernel"
+        << std::setw(10) << "ops"
+        << std::setw(12) << "ns/op"
+        << "ticks/op\n"
+        << THIN_LINE << '\n';
+
+    benchSquareMagic<PieceType::bishop>(corpus, "sliders::getSquareMagic bishop");
+    benchSquareMagic<PieceType::rook>(corpus, "sliders::getSquareMagic rook");
+    benchMoveGeneration(corpus);
+    benchMoveUndo(corpus);
+    benchZobrist(corpus);
+    benchTable<1>(keys);
+    benchTable<16>(keys);
+    benchTable<256>(keys);
+    benchEval(corpus);
+    const bool leaves_agree = benchLeafCount(corpus);
+
+    std::cout << THIN_LINE << '\n';
+    return (measurements.empty() || !leaves_agree) ? 1 : 0;
+}
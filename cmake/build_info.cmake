@@ -0,0 +1,20 @@
+# writes build_info.h with the git revision and build flags of the binary.
+# runs on every build (see CMakeLists.txt), the header is only touched if something changed
+# so a commit rebuilds the few files that include it, not everything.
+#
+# expects: SOURCE_DIR, OUTPUT, BUILD_FLAGS
+
+execute_process(
+    COMMAND git describe --always --dirty --abbrev=12
+    WORKING_DIRECTORY "${SOURCE_DIR}"
+    OUTPUT_VARIABLE SLOU_GIT_HASH
+    OUTPUT_STRIP_TRAILING_WHITESPACE
+    ERROR_QUIET
+)
+
+if(NOT SLOU_GIT_HASH)
+    set(SLOU_GIT_HASH "unknown")
+endif()
+
+set(SLOU_BUILD_FLAGS "${BUILD_FLAGS}")
+configure_file("${SOURCE_DIR}/cmake/build_info.h.in" "${OUTPUT}")
@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <stack>
+#include <utility>
 
 #include "definitions.h"
 #include "bitboard.h"
@@ -18,6 +19,7 @@ struct State {
     std::array<Piece, 64> mailbox { Piece::none };
     uint64_t ep_field;
 
+    // bit-fields are allocated from the lsb, see Board::CASTLE_WQ etc. for the resulting raw bits
     union {
         struct {
             bool white_qs : 1;
@@ -47,21 +49,63 @@ class Board {
     State* state;
     std::stack<MoveState> move_history;
 public:
+    // castling rights as bits of State::castling_rights.raw
+    static constexpr char CASTLE_WQ = 0b0001;
+    static constexpr char CASTLE_WK = 0b0010;
+    static constexpr char CASTLE_BQ = 0b0100;
+    static constexpr char CASTLE_BK = 0b1000;
+
     Board() : Board(STARTPOS) { }
     Board(const std::string& fen);
+    ~Board() { delete state; }
+
+    // copies are deep, so every thread of a parallel perft can work on its own board
+    Board(const Board& other) : state(new State(*other.state)), move_history(other.move_history) { }
+    Board(Board&& other) noexcept : state(std::exchange(other.state, nullptr)), move_history(std::move(other.move_history)) { }
+
+    Board& operator=(const Board& other)
+    {
+        if ( this != &other ) {
+            Board copy(other);
+            std::swap(state, copy.state);
+            std::swap(move_history, copy.move_history);
+        }
+        return *this;
+    }
+
+    Board& operator=(Board&& other) noexcept
+    {
+        std::swap(state, other.state);
+        std::swap(move_history, other.move_history);
+        return *this;
+    }
 
     std::string getFen() const;
 
     inline uint64_t getZobristKey() const { return state->zobrist_hash; }
-    inline bool whiteTurn() const { return utils::isWhite(state->cur_color); }
+
+    /**
+     * @brief   Computes the zobrist key of the position after 'move' without making it.
+     *          Used to start loading the TT entry of a child before the move is made.
+     *
+     * @tparam color    color to move
+     * @param move
+     * @return uint64_t the key board.move<color>(move) would produce
+     */
+    template <Color color> uint64_t getZobristKeyAfter(const Move& move) const;
+    constexpr bool whiteTurn() const { return utils::isWhite(state->cur_color); }
 
     template <Color color> void move(const Move& move);
     template <Color color> void undo(const Move& move);
 
+    // passes the turn to the other side, for null move pruning. color must not be in check
+    template <Color color> void makeNullMove();
+    template <Color color> void undoNullMove();
+
     template <Color color>
     constexpr bool isCheck(uint64_t enemy_attacks) const { return (enemy_attacks & getPieces<PieceType::king, color>()) != NULL_BB; }
 
-    char getRawCastlingRights() const { return state->castling_rights.raw; }
+    constexpr char getRawCastlingRights() const { return state->castling_rights.raw; }
 
     /**
      * @brief Get the index of the piece board
@@ -312,6 +356,21 @@ public:
     std::string toString() const;
 
 private:
+    /**
+     * @brief   Castling rights that survive a move touching this square,
+     *          a move from or to a king or rook square removes the matching rights.
+     */
+    static constexpr std::array<char, 64> castling_mask = [] {
+        std::array<char, 64> mask {};
+        mask.fill(~0);
+        mask[0] = ~CASTLE_WQ;
+        mask[4] = ~(CASTLE_WQ | CASTLE_WK);
+        mask[7] = ~CASTLE_WK;
+        mask[56] = ~CASTLE_BQ;
+        mask[60] = ~(CASTLE_BQ | CASTLE_BK);
+        mask[63] = ~CASTLE_BK;
+        return mask;
+    }();
 
     template <Color color>
     void storeState(const Move& move);
@@ -220,31 +220,78 @@ inline void Board::tryToRemoveCastlingRights(const Move& move)
 
         if ( to == enemy_rook_k ) {
             removeCastleKs<enemy_color>();
-
-            Zobrist::toggleCastlingKs<enemy_color>(state->zobrist_hash);
         }
         else if ( to == enemy_rook_q ) {
             removeCastleQs<enemy_color>();
-
-            Zobrist::toggleCastlingQs<enemy_color>(state->zobrist_hash);
         }
     }
 
     if ( from == my_rook_k ) {
         removeCastleKs<my_color>();
-
-        Zobrist::toggleCastlingKs<my_color>(state->zobrist_hash);
     }
     else if ( from == my_rook_q ) {
         removeCastleQs<my_color>();
-
-        Zobrist::toggleCastlingQs<my_color>(state->zobrist_hash);
     }
     else if ( moving_piece == king ) {
         removeCastle<my_color>();
+    }
+}
+
+// ================================
+// Zobrist key of a child position
+// ================================
+
+// has to mirror the zobrist updates done in move()
+template <Color color>
+uint64_t Board::getZobristKeyAfter(const Move& move) const
+{
+    constexpr Color enemy_color = utils::switchColor(color);
+    constexpr auto pawn_push_function = (utils::isWhite(color) ? north : south);
+
+    const uint64_t from = move.getFrom();
+    const uint64_t to = move.getTo();
+    const Move::Flag flag = move.getFlag();
+    const Piece moving_piece = getPiece(from);
+
+    uint64_t key = state->zobrist_hash;
 
-        Zobrist::toggleCastling<my_color>(state->zobrist_hash);
+    Zobrist::toggleBlackToMove(key);
+    Zobrist::toggleEnPassant(key, state->ep_field);
+
+    Zobrist::togglePiece(key, getIndex(moving_piece), from);
+    if ( move.isPromotion() ) {
+        Zobrist::togglePiece(key, getIndex(move.getPromotionPiece<color>()), to);
+    }
+    else {
+        Zobrist::togglePiece(key, getIndex(moving_piece), to);
+    }
+
+    if ( flag == Move::Flag::ep ) {
+        constexpr int offset = (utils::isWhite(color) ? -8 : 8);
+        Zobrist::togglePiece(key, getIndex<PieceType::pawn, enemy_color>(), to + offset);
+    }
+    else if ( move.isCapture() ) {
+        Zobrist::togglePiece(key, getIndex(getPiece(to)), to);
+    }
+    else if ( flag == Move::Flag::pawn_push ) {
+        Zobrist::toggleEnPassant(key, pawn_push_function(single_bit_u64(from)));
+        return key; // a double push never changes castling rights
     }
+    else if ( flag == Move::Flag::castle_k ) {
+        constexpr int rook_index = getIndex<PieceType::rook, color>();
+        Zobrist::togglePiece(key, rook_index, utils::isWhite(color) ? 7 : 63);
+        Zobrist::togglePiece(key, rook_index, utils::isWhite(color) ? 5 : 61);
+    }
+    else if ( flag == Move::Flag::castle_q ) {
+        constexpr int rook_index = getIndex<PieceType::rook, color>();
+        Zobrist::togglePiece(key, rook_index, utils::isWhite(color) ? 0 : 56);
+        Zobrist::togglePiece(key, rook_index, utils::isWhite(color) ? 3 : 59);
+    }
+
+    const char rights = state->castling_rights.raw;
+    Zobrist::toggleCastlingRights(key, rights ^ (rights & castling_mask[from] & castling_mask[to]));
+
+    return key;
 }
 
 // ================================
@@ -278,6 +325,8 @@ void Board::move(const Move& move)
         state->ep_field = new_ep_field;
         state->cur_color = enemy_color;
 
+        Zobrist::toggleEnPassant(state->zobrist_hash, new_ep_field);
+
         return; // early exit because we set the ep field
     }
 
@@ -294,8 +343,6 @@ void Board::move(const Move& move)
         movePiece<PieceType::rook, my_color>(rook_from, rook_to);
 
         removeCastle<my_color>();
-
-        Zobrist::toggleCastlingKs<my_color>(state->zobrist_hash);
     }
 
     else if ( move_flag == Move::Flag::castle_q ) {
@@ -306,8 +353,6 @@ void Board::move(const Move& move)
         movePiece<PieceType::rook, my_color>(rook_from, rook_to);
 
         removeCastle<my_color>();
-
-        Zobrist::toggleCastlingQs<my_color>(state->zobrist_hash);
     }
 
     else if ( move_flag == Move::Flag::capture ) {
@@ -337,6 +382,9 @@ void Board::move(const Move& move)
 
     state->ep_field = 0ULL;
     state->cur_color = enemy_color;
+
+    // all castling rights that were lost by this move, from either side
+    Zobrist::toggleCastlingRights(state->zobrist_hash, cur_state.castling_rights ^ state->castling_rights.raw);
 }
 
 template <Color color>
@@ -353,7 +401,7 @@ void Board::undo(const Move& move)
     MoveState last_state = move_history.top();
     move_history.pop();
 
-    state->cur_color = enemy_color;
+    state->cur_color = my_color;
     state->ep_field = last_state.ep_field;
     state->castling_rights.raw = last_state.castling_rights;
 
@@ -393,8 +441,8 @@ void Board::undo(const Move& move)
             movePiece<PieceType::rook, my_color>(rook_to, rook_from);
         }
 
-        Zobrist::toggleCastling<my_color>(state->zobrist_hash);
         movePiece<PieceType::king, my_color>(move_to, move_from);
+        state->zobrist_hash = last_state.zobrist_hash;
         return;
     }
     else if ( move.isEnpassant() ) {
@@ -415,4 +463,57 @@ void Board::undo(const Move& move)
     }
 
     state->zobrist_hash = last_state.zobrist_hash;
-}
\ No newline at end of file
+}
+
+template <Color color>
+void Board::makeNullMove()
+{
+    MoveState null_state;
+    null_state.ep_field = state->ep_field;
+    null_state.zobrist_hash = state->zobrist_hash;
+    null_state.castling_rights = state->castling_rights.raw;
+    move_history.push(null_state);
+
+    Zobrist::toggleBlackToMove(state->zobrist_hash);
+    Zobrist::toggleEnPassant(state->zobrist_hash, state->ep_field);
+
+    state->ep_field = 0ULL;
+    state->cur_color = utils::switchColor(color);
+}
+
+template <Color color>
+void Board::undoNullMove()
+{
+    const MoveState& last_state = move_history.top();
+
+    state->ep_field = last_state.ep_field;
+    state->zobrist_hash = last_state.zobrist_hash;
+    state->cur_color = color;
+
+    move_history.pop();
+}
+
+// ================================
+// Zobrist hash from scratch
+// ================================
+constexpr uint64_t Zobrist::computeHash(const Board& board)
+{
+    uint64_t hash = 0;
+
+    for ( int square = 0; square < kNumSquares; ++square ) {
+        int piece_id = board.getIndex(board.getPiece(square));
+        if ( piece_id != board.getIndex(Piece::none) ) {
+            hash ^= pieceKeys[piece_id][square];
+        }
+    }
+
+    if ( !board.whiteTurn() ) {
+        hash ^= blackToMove;
+    }
+
+    // same routine as the incremental update, so both always agree
+    toggleCastlingRights(hash, board.getRawCastlingRights());
+    toggleEnPassant(hash, board.getEpField());
+
+    return hash;
+}
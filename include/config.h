@@ -3,10 +3,28 @@
 #define TODO            std::cerr << RED << "TODO: " << RESET
 #define STARTPOS        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
 #define TTABLE_SIZE_MB  2
+
+// the zobrist keys are generated from this seed at compiletime.
+// changing it invalidates persisted perft tables, they are keyed by the zobrist hashes
+#ifndef ZOBRIST_SEED
+#define ZOBRIST_SEED    0x736c6f75ULL
+#endif
 #define ENABLE_LOGGER   
 
 #define ENABLE_DEBUG    0
 
+// counters for probes, hits, collisions and replacements of the transposition tables.
+// compiled out by default, enable with cmake -DSLOU_TT_STATS=ON
+#ifndef ENABLE_TT_STATS
+#define ENABLE_TT_STATS 0
+#endif
+
+// experimental perft leaf counter that counts the moves of several sibling leaves at once, see perft/simd_leaves.h.
+// off by default, enable with cmake -DSLOU_SIMD_LEAVES=ON (best together with -DSLOU_NATIVE=ON)
+#ifndef ENABLE_SIMD_LEAVES
+#define ENABLE_SIMD_LEAVES 0
+#endif
+
 // as testing for checks and mates is quite expensive i have added an option to disable them
 #ifndef SIMPLE_TEST
 #define SIMPLE_TEST     1
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <string>
 #include <array>
+#include <stdexcept>
 
 #define BIT_LOOP(X) for (; X != 0ULL ; X &= X - 1)
 
@@ -20,6 +21,12 @@ enum class Piece {
     none
 };
 
+// moves a generator adds. captures are the moves that change the material: captures,
+// en passant and promotions to a queen (under promotions are left out)
+enum class MoveType {
+    all, captures
+};
+
 namespace utils {
     inline constexpr uint8_t isBishop(PieceType type) { return type == PieceType::bishop; }
     inline constexpr uint8_t isRook(PieceType type) { return type == PieceType::rook; }
@@ -5,8 +5,15 @@
 #include "definitions.h"
 #include "board/board.h"
 #include "move_generator/move_generation.h"
+#include "search/score.h"
 
-static constexpr double INFTY = std::numeric_limits<double>::infinity();
+// material value of every PieceType, indexed by utils::toByte
+static constexpr std::array<Score, 6> PIECE_VALUES = { 100, 320, 320, 500, 900, 10000 };
+
+constexpr Score pieceValue(PieceType type)
+{
+    return PIECE_VALUES[utils::toByte(type)];
+}
 
 constexpr std::array<int, 64> flipTable(const std::array<int, 64>& table)
 {
@@ -113,21 +120,21 @@ const std::array<int, 64> getPositionBoard()
 }
 
 template <PieceType type>
-inline int getPieceScore(const Board& board, int value)
+inline int getPieceScore(const Board& board)
 {
     const uint64_t white_pieces = board.getPieces<type, Color::white>();
     const uint64_t black_pieces = board.getPieces<type, Color::black>();
-    return (get_bit_count(white_pieces) - get_bit_count(black_pieces)) * value;
+    return (get_bit_count(white_pieces) - get_bit_count(black_pieces)) * pieceValue(type);
 }
 
 inline int getMaterialScore(const Board& board)
 {
-    const int pawn_score = getPieceScore<PieceType::pawn>(board, 100);
-    const int knight_score = getPieceScore<PieceType::knight>(board, 320);
-    const int bishop_score = getPieceScore<PieceType::bishop>(board, 320);
-    const int rook_score = getPieceScore<PieceType::rook>(board, 500);
-    const int queen_score = getPieceScore<PieceType::queen>(board, 900);
-    const int king_score = getPieceScore<PieceType::king>(board, 10000);
+    const int pawn_score = getPieceScore<PieceType::pawn>(board);
+    const int knight_score = getPieceScore<PieceType::knight>(board);
+    const int bishop_score = getPieceScore<PieceType::bishop>(board);
+    const int rook_score = getPieceScore<PieceType::rook>(board);
+    const int queen_score = getPieceScore<PieceType::queen>(board);
+    const int king_score = getPieceScore<PieceType::king>(board);
 
     return pawn_score + knight_score + bishop_score + rook_score + queen_score + king_score;
 }
@@ -187,14 +194,21 @@ inline int getPositionalScore(const Board& board)
     return result;
 }
 
+// white's positional score minus black's
+inline int getPositionalScore(const Board& board)
+{
+    return getPositionalScore<Color::white>(board) + getPositionalScore<Color::black>(board);
+}
+
 template <Color color>
-inline double evalPosition(Board& board)
+inline Score evalPosition(Board& board)
 {
     const int material_score = getMaterialScore(board);
-    const int position_score = getPositionalScore<color>(board);
+    // both sides, the side to move alone would swing the score by a few hundred centipawns every ply
+    const int position_score = getPositionalScore(board);
     const int pawn_scores = getPawnScore(board);
 
-    const double score = material_score + position_score + pawn_scores;
+    const Score score = material_score + position_score + pawn_scores;
 
     if constexpr ( utils::isWhite(color) ) {
         return score;
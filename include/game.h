@@ -1,6 +1,13 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "definitions.h"
@@ -11,6 +18,16 @@
 #include "ttable.h"
 #include "eval.h"
 #include "config.h"
+#include "thread_pool.h"
+#include "perft/stats.h"
+#if ENABLE_SIMD_LEAVES
+#include "perft/simd_leaves.h"
+#endif
+#include "search/limits.h"
+#include "search/move_order.h"
+#include "search/params.h"
+#include "search/thread.h"
+#include "search/time_manager.h"
 
 class Game {
 private:
@@ -23,26 +40,221 @@ public:
     {
         board = Board();
         tt_perft = TTable<TTEntry_perft, TTABLE_SIZE_MB>();
+        threads.push_back(std::make_unique<SearchThread>(0));
+        initReductions();
     }
 
     Game(const std::string& fen);
 
-    void make_move(const std::string& algebraic_move);
+    ~Game() { stopSearch(); }
+
+    // like Game(fen), but keeps the transposition tables
+    void setPosition(const std::string& fen);
+
+    // false if the move is not legal in the current position
+    bool make_move(const std::string& algebraic_move);
     void unmake_move(const std::string& algebraic_move);
 
+    // search to a fixed depth, see search
     Move bestMove(int depth = 5);
 
-    uint64_t perftSimpleEntry(int depth);
-    uint64_t perftDetailEntry(int depth);
+    /**
+     * @brief   Iterative deepening within limits. Every iteration searches one ply deeper and
+     *          finds the results of the previous ones in tt_eval. An iteration that is aborted
+     *          by the hard time limit or the node limit is thrown away, so the result is always
+     *          the one of the last finished iteration. The first iteration is never aborted.
+     *
+     * @param report    called with the result of every finished iteration
+     * @return          best_move is Move() if there are no legal moves
+     */
+    SearchInfo search(const SearchLimits& limits, const std::function<void(const SearchInfo&)>& report = {});
+
+    /**
+     * @brief   Runs search on a thread of its own and returns at once, a search that is still
+     *          running is stopped first. done is called on the search thread with the result.
+     *          With limits.infinite or limits.ponder the search does not end on its own, even
+     *          if it runs out of depth, but waits for stopSearch or ponderhit.
+     */
+    void startSearch(const SearchLimits& limits, std::function<void(const SearchInfo&)> report, std::function<void(const SearchInfo&)> done);
+
+    // ends the search of startSearch as soon as it has a move and waits until done has been called
+    void stopSearch();
+
+    // the opponent played the pondered move, the search now counts its time from the limits
+    void ponderhit() { pondering = false; }
+
+    /**
+     * @brief   Sets one of SEARCH_OPTIONS, "Threads", the number of threads of the search, or
+     *          "SplitMode", "SharedTT" or "YBWC". Numbers are clamped to their range.
+     *          false if there is no option with that name or the value is not valid.
+     */
+    bool setOption(const std::string& name, const std::string& value);
+
+    static constexpr int MAX_THREADS = 256;
+
+    // threads > 1 splits the tree and counts the subtrees on a work stealing pool, see parallelPerft
+    uint64_t perftSimpleEntry(int depth, int threads = 1);
+    uint64_t perftDetailEntry(int depth, int threads = 1);
+
+    // perft of any board with the tables of this game, several threads may call this at once
+    uint64_t perftBoard(Board& board, int depth);
+
+    // node count below every legal move, in the order of the move generator
+    std::vector<std::pair<Move, uint64_t>> perftDivide(int depth, int threads = 1);
+
+    // perft that also counts captures, checks, mates etc. of the last ply, without the perft table
+    PerftStats perftStatsEntry(int depth, int threads = 1);
+
+    // persisted perft table, see TTable::load/store
+    bool loadPerftTable(const std::string& path);
+    bool storePerftTable(const std::string& path) const;
 
     std::string toString() const { return board.toString(); }
 
+    int perftHashfull() const { return tt_perft.hashfull(); }
+    int evalHashfull() const { return tt_eval.hashfull(); }
+#if ENABLE_TT_STATS
+    const TTStats& perftTableStats() const { return tt_perft.stats(); }
+    const TTStats& evalTableStats() const { return tt_eval.stats(); }
+#endif
+
+    /**
+     * @brief   Searches the board of thread with the window (alpha, beta). score is set to the score of the
+     *          returned move. If score <= alpha or score >= beta it is only a bound, and the move
+     *          should not be trusted after a fail low.
+     */
     template <Color color>
-    Move getBestMove(Board& board, int depth = 5);
+    Move getBestMove(SearchThread& thread, int depth, Score& score, Score alpha = -INFTY, Score beta = INFTY);
 
 private:
+    // a subtree of a parallel perft, root is the index of the root move it belongs to
+    struct PerftTask {
+        Board board;
+        int depth;
+        size_t root;
+    };
+
+    // tasks a parallel perft aims for per thread, enough for stealing to even out uneven subtrees
+    static constexpr size_t PERFT_TASKS_PER_THREAD = 16;
+
+    // the limits are checked every SEARCH_CHECKPOINT nodes, has to be a power of two
+    static constexpr uint64_t SEARCH_CHECKPOINT = 2048;
+    static constexpr int MAX_SEARCH_DEPTH = 64;
+    // positional gain a capture may bring on top of the captured material, see quiescence
+    static constexpr Score DELTA_MARGIN = 200;
+    // iterations from this depth on search a window of +-ASPIRATION_WINDOW around the previous score,
+    // the window doubles on every fail low or high
+    static constexpr int ASPIRATION_DEPTH = 4;
+    static constexpr Score ASPIRATION_WINDOW = 25;
+
+    // state of the running search, see search
+    SearchLimits search_limits;
+    TimeManager time_manager;
+    std::chrono::steady_clock::time_point search_begin;
+    bool search_white = true;           // side to move at the root
+    bool search_has_result = false;     // the main thread finished an iteration, so there is a move to fall back to
+    bool clock_started = false;         // false while pondering
+
+    // set by other threads, only read at the checkpoints of the search
+    std::atomic<bool> stop_requested { false };
+    std::atomic<bool> pondering { false };
+    std::thread search_thread;
+
+    // threads[0] is the main thread, it runs on the thread that called search, the others are helpers
+    std::vector<std::unique_ptr<SearchThread>> threads;
+    // set by the main thread once it is done, the helpers stop at their next checkpoint
+    std::atomic<bool> helpers_stop { false };
+    // set by the main thread once the current iteration is aborted
+    std::atomic<bool> search_aborted { false };
+
+    SplitMode split_mode = SplitMode::shared_tt;
+    // split points idle threads can join
+    std::mutex split_mutex;
+    std::vector<SplitPoint*> split_points;
+    std::atomic<int> idle_threads { 0 };
+    // smaller subtrees are not worth the synchronization of a split
+    static constexpr int SPLIT_MIN_DEPTH = 4;
+
+    bool canSplit(int depth) const
+    {
+        return split_mode == SplitMode::ybwc && depth >= SPLIT_MIN_DEPTH && idle_threads.load(std::memory_order_relaxed) > 0;
+    }
+
+    // helper i skips the iterations where (depth + SKIP_PHASE[i]) / SKIP_SIZE[i] is odd, so the helpers
+    // spread over the depth of the main thread and the ones after it instead of all searching the same one
+    static constexpr std::array<int, 20> SKIP_SIZE = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+    static constexpr std::array<int, 20> SKIP_PHASE = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+    // search without resetting stop_requested and pondering
+    SearchInfo runSearch(const SearchLimits& limits, const std::function<void(const SearchInfo&)>& report);
+
+    // iterative deepening of one thread, report is only called by the main thread
+    void iterate(SearchThread& thread, int max_depth, const std::function<void(const SearchInfo&)>& report);
+
+    // a helper with SplitMode::ybwc, joins split points until the main thread is done
+    void idleLoop(SearchThread& thread);
+
+    /**
+     * @brief   Takes the split point closest to the root that did not fail high and counts the
+     *          calling thread as one of its workers. With an ancestor only split points below it
+     *          are taken, the master of the ancestor may only help with those as they are done
+     *          before the ancestor is.
+     *
+     * @return SplitPoint*  nullptr if there is none
+     */
+    SplitPoint* pickSplitPoint(const SplitPoint* ancestor);
+
+    // searches moves of a split point taken with pickSplitPoint, then leaves it
+    void joinSplitPoint(SearchThread& thread, SplitPoint& split_point);
+
+    /**
+     * @brief   Result of a search with several threads. Every thread that finished an iteration
+     *          votes for its move, weighted by its depth and by how much its score beats the
+     *          worst one. Of the threads that voted for the winning move, the deepest one is taken.
+     */
+    SearchInfo voteResult() const;
+
+    // nodes of all threads of the running search
+    uint64_t totalNodes() const;
+
+    SearchParams params;
+    // late move reduction by [depth][moves searched], computed from params
+    std::array<std::array<int, 64>, MAX_SEARCH_DEPTH + 1> reductions;
+
+    void initReductions();
+
+    /**
+     * @brief   Sets thread.stopped once stopSearch was called or the hard time limit or the node
+     *          limit is reached. Only the main thread looks at the limits, a helper stops when the
+     *          main thread is done.
+     */
+    void checkLimits(SearchThread& thread);
+
     Move moveFromSring(const std::string& algebraic_move);
 
+    /**
+     * @brief   Perft on several threads. The tree is split a few plies down until there are
+     *          about PERFT_TASKS_PER_THREAD subtrees per thread, which are then counted on a
+     *          work stealing pool. All threads share tt_perft, so transpositions between
+     *          subtrees are still only counted once.
+     *
+     * @tparam Result       what count returns for a subtree, summed up with +=
+     * @param root_moves    filled with the moves of the current position
+     * @param count         counts the subtree of a PerftTask
+     * @return              result below every root move, in the order of root_moves
+     */
+    template <typename Result, typename Count>
+    std::vector<Result> parallelPerft(int depth, int threads, MoveList& root_moves, Count count);
+
+    // the tasks of a parallel perft, see parallelPerft
+    std::vector<PerftTask> splitRoot(int depth, int threads, MoveList& root_moves);
+
+    // replaces every task by one task per legal move, one ply deeper
+    std::vector<PerftTask> splitPerft(std::vector<PerftTask>& tasks);
+
+    template <Color color>
+    void splitPerft(PerftTask& task, std::vector<PerftTask>& children);
+
     template <Color color, bool print_moves = false>
     uint64_t perft(Board& board, int depth);
 
@@ -51,7 +263,57 @@ private:
     uint64_t debug_perft(Board& board, int depth);
 
     template <Color color>
-    double minimax(Board& board, int depth, double alpha, double beta);
+    void perftStats(Board& board, int depth, PerftStats& stats);
+
+    // single threaded perftDivide
+    template <Color color>
+    std::vector<uint64_t> divide(int depth, MoveList& root_moves);
+
+    /**
+     * @brief   Negamax, ply is the distance to the root. Zero window nodes that are not in check
+     *          are pruned selectively, see SearchParams. allow_null is false right after a null
+     *          move, so no side passes twice in a row.
+     */
+    template <Color color>
+    Score minimax(SearchThread& thread, int depth, int ply, Score alpha, Score beta, bool allow_null = true);
+
+    /**
+     * @brief   Makes move, searches it as move number moves_searched of node with the reductions
+     *          of minimax and takes it back. A futile move is not searched, pruned is set and the
+     *          score is the upper bound it got.
+     */
+    template <Color color>
+    Score searchMove(SearchThread& thread, const SearchNode& node, Move move, int moves_searched, Score alpha, bool& pruned);
+
+    // searches the remaining moves of split_point together with the idle threads that join it
+    template <Color color>
+    void split(SearchThread& thread, SplitPoint& split_point);
+
+    // searches moves of split_point until none is left or one fails high, thread.board is at its position
+    template <Color color>
+    void searchSplitPoint(SearchThread& thread, SplitPoint& split_point);
+
+    /**
+     * @brief   Score of a move that was just made, from the view of the side that made it. The
+     *          first move of a node gets the full window, every later one is expected to be worse
+     *          and only gets a zero window probe (principal variation search). If the probe
+     *          beats alpha anyway, it is searched again with the full window.
+     *          A late move is probed reduction plies shallower first and only searched to the
+     *          full depth if that probe beats alpha.
+     *
+     * @tparam color    color to move after the move
+     */
+    template <Color color>
+    Score pvs(SearchThread& thread, int depth, int ply, Score alpha, Score beta, bool first_move, int reduction = 0);
+
+    /**
+     * @brief   Search of the captures below the horizon of minimax, until the position is quiet.
+     *          The side to move may stand pat on the static eval instead of capturing, a capture
+     *          that could not raise alpha even with DELTA_MARGIN on top is skipped (delta pruning).
+     *          In check there is no standing pat, all evasions are searched.
+     */
+    template <Color color>
+    Score quiescence(SearchThread& thread, int ply, Score alpha, Score beta);
 };
 
 template <Color color, bool print_moves>
@@ -59,7 +321,9 @@ uint64_t Game::perft(Board& board, int depth)
 {
     uint64_t nodes = 0ULL;
     uint64_t key = board.getZobristKey();
-    if ( tt_perft.if_has_get(key, depth, nodes) ) {
+
+    // depth 1 is never stored, so the lookup would only cost a cache miss
+    if ( depth > 1 && tt_perft.if_has_get(key, depth, nodes) ) {
         return nodes;
     }
 
@@ -70,7 +334,36 @@ uint64_t Game::perft(Board& board, int depth)
         return list.size();
     }
 
+#if ENABLE_SIMD_LEAVES
+    // the children are leaves, count their moves a batch at a time instead of one by one
+    if ( !print_moves && depth == 2 ) {
+        constexpr Color enemy_color = utils::switchColor(color);
+        simd_leaves::Batch batch;
+        for ( const auto& move : list ) {
+            board.move<color>(move);
+            batch.add<enemy_color>(board);
+            board.undo<color>(move);
+
+            if ( batch.full() ) {
+                nodes += simd_leaves::count<enemy_color>(batch);
+                batch.clear();
+            }
+        }
+
+        if ( !batch.empty() ) {
+            nodes += simd_leaves::count<enemy_color>(batch);
+        }
+
+        tt_perft.store(key, depth, nodes);
+        return nodes;
+    }
+#endif
+
     for ( const auto& move : list ) {
+        if ( depth > 2 ) {
+            tt_perft.prefetch(board.getZobristKeyAfter<color>(move));
+        }
+
         board.move<color>(move);
         if constexpr ( print_moves ) {
             const uint64_t move_nodes = perft<utils::switchColor(color), false>(board, depth - 1);
@@ -83,10 +376,43 @@ uint64_t Game::perft(Board& board, int depth)
         board.undo<color>(move);
     }
 
-    tt_perft.emplace(key, nodes, depth);
+    tt_perft.store(key, depth, nodes);
     return nodes;
 }
 
+template <typename Result, typename Count>
+std::vector<Result> Game::parallelPerft(int depth, int threads, MoveList& root_moves, Count count)
+{
+    std::vector<PerftTask> tasks = splitRoot(depth, threads, root_moves);
+    std::vector<Result> task_results(tasks.size());
+    {
+        ThreadPool pool(threads);
+        for ( size_t i = 0; i < tasks.size(); ++i ) {
+            pool.submit([&tasks, &task_results, &count, i] { task_results[i] = count(tasks[i]); });
+        }
+        pool.wait();
+    }
+
+    std::vector<Result> results(root_moves.size());
+    for ( size_t i = 0; i < tasks.size(); ++i ) {
+        results[tasks[i].root] += task_results[i];
+    }
+
+    return results;
+}
+
+template <Color color>
+void Game::splitPerft(PerftTask& task, std::vector<PerftTask>& children)
+{
+    MoveList list;
+    generate_moves<color>(list, task.board);
+
+    for ( const auto& move : list ) {
+        children.push_back(PerftTask { task.board, task.depth - 1, task.root });
+        children.back().board.move<color>(move);
+    }
+}
+
 template <Color color, bool print_moves>
 uint64_t Game::debug_perft(Board& board, int depth)
 {
@@ -116,64 +442,221 @@ uint64_t Game::debug_perft(Board& board, int depth)
         board.undo<color>(move);
     }
 
-    tt_perft.emplace(key, nodes, depth);
+    tt_perft.store(key, depth, nodes);
     return nodes;
 }
 
 template <Color color>
-Move Game::getBestMove(Board& board, int depth)
+std::vector<uint64_t> Game::divide(int depth, MoveList& root_moves)
 {
-    uint64_t key = board.getZobristKey();
-    if ( tt_eval.has(key, depth) ) {
-        auto entry = tt_eval.get(key);
-        if ( entry.type == TTEntry_eval::EXACT ) {
-            return entry.best_move;
+    generate_moves<color>(root_moves, board);
+
+    std::vector<uint64_t> nodes(root_moves.size(), 1ULL);
+    if ( depth > 1 ) {
+        for ( size_t i = 0; i < root_moves.size(); ++i ) {
+            board.move<color>(root_moves[i]);
+            nodes[i] = perft<utils::switchColor(color)>(board, depth - 1);
+            board.undo<color>(root_moves[i]);
         }
     }
 
+    return nodes;
+}
+
+template <Color color>
+void Game::perftStats(Board& board, int depth, PerftStats& stats)
+{
+    constexpr Color enemy_color = utils::switchColor(color);
+
+    MoveList list;
+    generate_moves<color>(list, board);
+
+    if ( depth > 1 ) {
+        for ( const auto& move : list ) {
+            board.move<color>(move);
+            perftStats<enemy_color>(board, depth - 1, stats);
+            board.undo<color>(move);
+        }
+        return;
+    }
+
+    stats.nodes += list.size();
+    for ( const auto& move : list ) {
+        stats.captures += move.isCapture();
+        stats.en_passants += move.isEnpassant();
+        stats.castles += move.isCastle();
+        stats.promotions += move.isPromotion();
+
+        board.move<color>(move);
+
+        const u64 checkers = generate_checkers<color>(board);
+        if ( checkers != 0ULL ) {
+            // for castling the rook is the piece that moved into the check
+            const int moved_to = move.isKingCastle() ? (utils::isWhite(color) ? 5 : 61)
+                : move.isQueenCastle() ? (utils::isWhite(color) ? 3 : 59)
+                : move.getTo();
+
+            const bool double_check = get_bit_count(checkers) > 1;
+
+            ++stats.checks;
+            stats.double_checks += double_check;
+            stats.discovered_checks += !double_check && checkers != single_bit_u64(moved_to);
+
+            MoveList replies;
+            generate_moves<enemy_color>(replies, board);
+            stats.checkmates += replies.size() == 0;
+        }
+
+        board.undo<color>(move);
+    }
+}
+
+template <Color color>
+Move Game::getBestMove(SearchThread& thread, int depth, Score& score, Score alpha, Score beta)
+{
+    Board& board = thread.board;
+    uint64_t key = board.getZobristKey();
+
     MoveList move_list;
     generate_moves<color>(move_list, board);
 
     assert(move_list.size() != 0 && "no moves to generate! in getBestMove()");
 
+    // only an exact score ends the root, and only with a move that is legal here (keys can collide)
+    TTEntry_eval::Data entry;
+    const bool tt_hit = tt_eval.probe(key, entry);
+    if ( tt_hit && entry.depth_searched >= depth && entry.type == TTEntry_eval::EXACT
+         && std::find(move_list.begin(), move_list.end(), entry.best_move) != move_list.end() ) {
+        score = scoreFromTT(entry.best_score, 0);
+        return entry.best_move;
+    }
+
+    // the best move of the previous iteration goes first
+    ScoredMoves moves(move_list);
+    thread.ordering.score<color>(moves, board, tt_hit ? entry.best_move : Move(), 0);
+
+    const Score alpha_start = alpha;
     Move best_move;
-    double best_score = -INFTY;  // negamax, so we initialize to -INFTY
-    double alpha = -INFTY;
-    double beta = INFTY;
+    Score best_score = -INFTY;  // negamax, so we initialize to -INFTY
+
+    Move move;
+    while ( moves.next(move) ) {
+        tt_eval.prefetch(board.getZobristKeyAfter<color>(move));
 
-    for ( const auto& move : move_list ) {
+        thread.ordering.play(0, move, board.getPieceType(move.getFrom()));
         board.move<color>(move);
-        double score = -minimax<utils::switchColor(color)>(board, depth - 1, -beta, -alpha);
+        const Score move_score = pvs<utils::switchColor(color)>(thread, depth - 1, 1, alpha, beta, best_move == Move());
         board.undo<color>(move);
 
-        if ( score > best_score ) {
-            best_score = score;
+        // the score of an aborted subtree is meaningless, the caller throws the iteration away
+        if ( thread.stopped ) {
+            return best_move;
+        }
+
+        if ( move_score > best_score ) {
+            best_score = move_score;
             best_move = move;
         }
 
-        alpha = std::max(alpha, score);
+        alpha = std::max(alpha, move_score);
         if ( alpha >= beta ) {
             break;  // pruning
         }
     }
 
-    tt_eval.emplace(key, depth, best_score, best_move, TTEntry_eval::EXACT);
+    // an aspiration window that failed only leaves a bound, that must not be taken as the root score
+    auto type = TTEntry_eval::EXACT;
+    if ( best_score <= alpha_start ) {
+        type = TTEntry_eval::UPPERBOUND;
+    }
+    else if ( best_score >= beta ) {
+        type = TTEntry_eval::LOWERBOUND;
+    }
+
+    tt_eval.emplace(key, depth, scoreToTT(best_score, 0), best_move, type);
+    score = best_score;
 
     assert(best_move != Move() && "wtf!");
     return best_move;
 }
 
 template <Color color>
-double Game::minimax(Board& board, int depth, double alpha, double beta)
+Score Game::minimax(SearchThread& thread, int depth, int ply, Score alpha, Score beta, bool allow_null)
 {
+    Board& board = thread.board;
+    constexpr Color enemy_color = utils::switchColor(color);
+
+    if ( (thread.countNode() & (SEARCH_CHECKPOINT - 1)) == 0 ) {
+        checkLimits(thread);
+    }
+
+    // aborted, or another thread failed high at a split point above and nobody needs this subtree anymore
+    if ( thread.stopped ) {
+        return 0;
+    }
+
+    // an entry of at least this depth ends the node if its bound is enough for the window,
+    // otherwise its move is still the best guess to search first
     uint64_t key = board.getZobristKey();
-    if ( tt_eval.has(key, depth) ) {
-        auto entry = tt_eval.get(key);
-        return entry.best_score;
+    TTEntry_eval::Data entry;
+    const bool tt_hit = tt_eval.probe(key, entry);
+    if ( tt_hit && entry.depth_searched >= depth ) {
+        const Score tt_score = scoreFromTT(entry.best_score, ply);
+        if ( entry.type == TTEntry_eval::EXACT
+             || (entry.type == TTEntry_eval::LOWERBOUND && tt_score >= beta)
+             || (entry.type == TTEntry_eval::UPPERBOUND && tt_score <= alpha) ) {
+            return tt_score;
+        }
     }
 
-    if ( depth == 0 ) {
-        return evalPosition<color>(board);
+    if ( depth <= 0 ) {
+        return quiescence<color>(thread, ply, alpha, beta);
+    }
+
+    // a zero window node only has to tell if it fails high or low, that is where the search may guess
+    const bool pv_node = beta - alpha > 1;
+    const bool in_check = generate_checkers<enemy_color>(board) != 0ULL;
+    const bool selective = !pv_node && !in_check && !isMateScore(beta);
+    const Score static_eval = selective ? evalPosition<color>(board) : 0;
+
+    // reverse futility pruning: far enough above beta that no move is going to drop below it
+    if ( selective && depth <= params.rfp_max_depth && static_eval - params.rfp_margin * depth >= beta ) {
+        return static_eval;
+    }
+
+    // null move pruning: if passing still fails high, a real move would too. not with only pawns
+    // left, where passing can be the best move (zugzwang)
+    if ( selective && allow_null && depth >= params.null_move_min_depth && static_eval >= beta ) {
+        const uint64_t minors = board.getPieces<PieceType::knight, color>() | board.getPieces<PieceType::bishop, color>();
+        const uint64_t majors = board.getPieces<PieceType::rook, color>() | board.getPieces<PieceType::queen, color>();
+        const int pieces = get_bit_count(minors | majors);
+
+        if ( pieces > 0 ) {
+            const int null_depth = depth - 1 - params.null_move_reduction - depth / 6;
+
+            thread.ordering.play(ply, Move(), PieceType::none);
+            board.makeNullMove<color>();
+            Score score = -minimax<enemy_color>(thread, null_depth, ply + 1, -beta, -beta + 1, false);
+            board.undoNullMove<color>();
+
+            if ( thread.stopped ) {
+                return 0;
+            }
+
+            if ( score >= beta ) {
+                // a mate found after passing is not a mate the side to move can force
+                score = isMateScore(score) ? beta : score;
+
+                // deep nodes and a single piece left are where zugzwang hurts, a search without null moves has to confirm
+                if ( depth < params.null_move_verify_depth && pieces > 1 ) {
+                    return score;
+                }
+
+                if ( minimax<color>(thread, null_depth, ply, beta - 1, beta, false) >= beta ) {
+                    return score;
+                }
+            }
+        }
     }
 
     MoveList move_list;
@@ -181,40 +664,317 @@ double Game::minimax(Board& board, int depth, double alpha, double beta)
 
     // no moves -> checkmate or stalemate
     if ( move_list.size() == 0 ) {
-        const uint64_t enemy_attacks = generate_attacks<utils::switchColor(color)>(board);
-        if ( board.isCheck<color>(enemy_attacks) ) {
-            return (utils::isWhite(color)) ? INFTY : -INFTY;
-        }
-        else {
+        return in_check ? matedIn(ply) : 0;
+    }
+
+    ScoredMoves moves(move_list);
+    thread.ordering.score<color>(moves, board, tt_hit ? entry.best_move : Move(), ply);
+
+    // futility pruning: quiet moves can not raise a static eval this far below alpha
+    const bool futile = selective && depth <= params.futility_max_depth && static_eval + params.futility_margin * depth <= alpha;
+
+    const SearchNode node { depth, ply, beta, pv_node, in_check, futile, static_eval };
+
+    // quiet moves that did not cause a cutoff, their history is lowered if a later one does
+    std::array<Move, 256> quiets_tried;
+    size_t quiet_count = 0;
+
+    // the bound of the result depends on the window it was searched with, not on the raised alpha
+    const Score alpha_start = alpha;
+    Score best_score = -INFTY;  // negamax, so we initialize to -INFTY
+    Move best_move;
+    int moves_searched = 0;
+    Move move;
+    while ( moves.next(move) ) {
+        const bool quiet = !move.isCapture() && !move.isPromotion();
+
+        bool pruned = false;
+        const Score score = searchMove<color>(thread, node, move, moves_searched, alpha, pruned);
+
+        // unwind without storing anything, the scores below an abort are meaningless
+        if ( thread.stopped ) {
             return 0;
         }
-    }
 
-    double best_score = -INFTY;  // negamax, so we initialize to -INFTY
-    for ( const auto& move : move_list ) {
-        board.move<color>(move);
-        double score = -minimax<utils::switchColor(color)>(board, depth - 1, -beta, -alpha);
-        board.undo<color>(move);
+        if ( pruned ) {
+            best_score = std::max(best_score, score);
+            continue;
+        }
+        ++moves_searched;
 
         if ( score > best_score ) {
             best_score = score;
+            best_move = move;
         }
 
         alpha = std::max(alpha, score);
         if ( alpha >= beta ) {
+            if ( quiet ) {
+                thread.ordering.updateQuiet<color>(board, move, quiets_tried.data(), quiet_count, depth, ply);
+            }
             break;  // Alpha-beta pruning
         }
+
+        if ( quiet ) {
+            quiets_tried[quiet_count++] = move;
+        }
+
+        // young brothers wait: the first move is searched alone, the rest may be shared with idle threads
+        if ( canSplit(depth) && moves.index < move_list.size() ) {
+            SplitPoint split_point(board, node, moves);
+            split_point.alpha = alpha;
+            split_point.best_score = best_score;
+            split_point.best_move = best_move;
+            split_point.moves_searched = moves_searched;
+
+            split<color>(thread, split_point);
+            if ( thread.stopped ) {
+                return 0;
+            }
+
+            best_score = split_point.best_score;
+            best_move = split_point.best_move;
+            alpha = split_point.alpha;
+            break;
+        }
     }
 
     auto type = TTEntry_eval::EXACT;
-    if ( best_score <= alpha ) {
+    if ( best_score <= alpha_start ) {
         type = TTEntry_eval::UPPERBOUND;
     }
     else if ( best_score >= beta ) {
         type = TTEntry_eval::LOWERBOUND;
     }
 
-    tt_eval.emplace(key, depth, best_score, Move(), type);
+    tt_eval.emplace(key, depth, scoreToTT(best_score, ply), best_move, type);
+
+    return best_score;
+}
+
+template <Color color>
+Score Game::searchMove(SearchThread& thread, const SearchNode& node, Move move, int moves_searched, Score alpha, bool& pruned)
+{
+    constexpr Color enemy_color = utils::switchColor(color);
+    Board& board = thread.board;
+
+    tt_eval.prefetch(board.getZobristKeyAfter<color>(move));
+
+    const bool quiet = !move.isCapture() && !move.isPromotion();
+
+    thread.ordering.play(node.ply, move, board.getPieceType(move.getFrom()));
+    board.move<color>(move);
+
+    const bool gives_check = generate_checkers<color>(board) != 0ULL;
+    if ( node.futile && quiet && !gives_check && moves_searched > 0 ) {
+        board.undo<color>(move);
+        pruned = true;
+        return node.static_eval + params.futility_margin * node.depth;
+    }
+
+    // late move reductions: quiet moves late in the ordering are searched shallower first
+    int reduction = 0;
+    if ( quiet && !node.in_check && !gives_check && node.depth >= params.lmr_min_depth && moves_searched >= params.lmr_min_moves ) {
+        reduction = reductions[std::min(node.depth, MAX_SEARCH_DEPTH)][std::min(moves_searched, 63)] - node.pv_node;
+        reduction = std::clamp(reduction, 0, node.depth - 1);
+    }
+
+    const Score score = pvs<enemy_color>(thread, node.depth - 1, node.ply + 1, alpha, node.beta, moves_searched == 0, reduction);
+    board.undo<color>(move);
+
+    return score;
+}
+
+template <Color color>
+void Game::split(SearchThread& thread, SplitPoint& split_point)
+{
+    SplitPoint* const parent = thread.split_point;
+    split_point.color = color;
+    split_point.parent = parent;
+    if ( split_point.node.ply > 0 ) {
+        split_point.previous_move = thread.ordering.played[split_point.node.ply - 1];
+        split_point.previous_piece = thread.ordering.played_piece[split_point.node.ply - 1];
+    }
+    split_point.working.push_back(&thread);
+    if ( parent != nullptr ) {
+        // a cutoff above reaches this split point through the children of its parent
+        std::lock_guard<std::mutex> lock(parent->mutex);
+        parent->children.push_back(&split_point);
+        split_point.cutoff = parent->cutoff.load();
+    }
+    {
+        std::lock_guard<std::mutex> lock(split_mutex);
+        split_points.push_back(&split_point);
+    }
+    thread.split_point = &split_point;
+
+    searchSplitPoint<color>(thread, split_point);
+
+    // once it is gone from the list no thread can join anymore, the ones that did have to finish
+    {
+        std::lock_guard<std::mutex> lock(split_mutex);
+        split_points.erase(std::find(split_points.begin(), split_points.end(), &split_point));
+    }
+
+    // instead of only waiting, help the threads that are still here at the split points they made below
+    ++idle_threads;
+    while ( split_point.workers.load() > 1 ) {
+        if ( thread.id == 0 ) {
+            checkLimits(thread);
+        }
+
+        SplitPoint* below = split_point.cutoff || search_aborted ? nullptr : pickSplitPoint(&split_point);
+        if ( below == nullptr ) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        joinSplitPoint(thread, *below);
+        thread.board = split_point.board;
+    }
+    --idle_threads;
+
+    // a cutoff at this split point only ends its moves, the node above goes on
+    thread.split_point = parent;
+    if ( parent != nullptr ) {
+        std::lock_guard<std::mutex> lock(parent->mutex);
+        parent->children.erase(std::find(parent->children.begin(), parent->children.end(), &split_point));
+        thread.stopped = search_aborted || parent->cutoff;
+    }
+    else {
+        thread.stopped = search_aborted.load();
+    }
+}
+
+template <Color color>
+void Game::searchSplitPoint(SearchThread& thread, SplitPoint& split_point)
+{
+    const SearchNode& node = split_point.node;
+
+    while ( true ) {
+        Move move;
+        Score alpha;
+        int moves_searched;
+        {
+            std::lock_guard<std::mutex> lock(split_point.mutex);
+            if ( split_point.cutoff || !split_point.moves.next(move) ) {
+                return;
+            }
+            alpha = split_point.alpha;
+            // taken before the search so moves searched at the same time get their own index
+            moves_searched = split_point.moves_searched++;
+        }
+
+        bool pruned = false;
+        const Score score = searchMove<color>(thread, node, move, moves_searched, alpha, pruned);
+        if ( thread.stopped ) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(split_point.mutex);
+        // like the serial loop, only searched moves count for the reductions and futility pruning of later ones
+        if ( pruned ) {
+            --split_point.moves_searched;
+        }
+
+        if ( score > split_point.best_score ) {
+            split_point.best_score = score;
+            split_point.best_move = pruned ? split_point.best_move : move;
+        }
+
+        if ( !pruned && score > split_point.alpha ) {
+            split_point.alpha = score;
+            if ( score >= node.beta ) {
+                split_point.cutOff();
+                if ( !move.isCapture() && !move.isPromotion() ) {
+                    thread.ordering.updateQuiet<color>(thread.board, move, nullptr, 0, node.depth, node.ply);
+                }
+                return;
+            }
+        }
+    }
+}
+
+template <Color color>
+Score Game::pvs(SearchThread& thread, int depth, int ply, Score alpha, Score beta, bool first_move, int reduction)
+{
+    if ( first_move ) {
+        return -minimax<color>(thread, depth, ply, -beta, -alpha);
+    }
+
+    if ( reduction > 0 ) {
+        const Score score = -minimax<color>(thread, depth - reduction, ply, -alpha - 1, -alpha);
+        if ( score <= alpha || thread.stopped ) {
+            return score;
+        }
+    }
+
+    const Score score = -minimax<color>(thread, depth, ply, -alpha - 1, -alpha);
+    if ( score > alpha && score < beta && !thread.stopped ) {
+        return -minimax<color>(thread, depth, ply, -beta, -alpha);
+    }
+    return score;
+}
+
+template <Color color>
+Score Game::quiescence(SearchThread& thread, int ply, Score alpha, Score beta)
+{
+    Board& board = thread.board;
+    constexpr Color enemy_color = utils::switchColor(color);
+
+    if ( (thread.countNode() & (SEARCH_CHECKPOINT - 1)) == 0 ) {
+        checkLimits(thread);
+    }
+
+    if ( ply >= MAX_PLY ) {
+        return evalPosition<color>(board);
+    }
+
+    // in check every evasion has to be tried, without any the side to move is mated
+    const bool in_check = generate_checkers<enemy_color>(board) != 0ULL;
+    const Score stand_pat = in_check ? matedIn(ply) : evalPosition<color>(board);
+
+    if ( stand_pat >= beta ) {
+        return stand_pat;
+    }
+    alpha = std::max(alpha, stand_pat);
+
+    MoveList move_list;
+    if ( in_check ) {
+        generate_moves<color>(move_list, board);
+    }
+    else {
+        generate_moves<color, MoveType::captures>(move_list, board);
+    }
+
+    ScoredMoves moves(move_list);
+    for ( size_t i = 0; i < move_list.size(); ++i ) {
+        moves.scores[i] = mvvLva(board, move_list[i]);
+    }
+
+    Score best_score = stand_pat;
+    Move move;
+    while ( moves.next(move) ) {
+        if ( !in_check && stand_pat + materialGain(board, move) + DELTA_MARGIN <= alpha ) {
+            continue;
+        }
+
+        board.move<color>(move);
+        const Score score = -quiescence<enemy_color>(thread, ply + 1, -beta, -alpha);
+        board.undo<color>(move);
+
+        if ( thread.stopped ) {
+            return 0;
+        }
+
+        if ( score > best_score ) {
+            best_score = score;
+            alpha = std::max(alpha, score);
+            if ( alpha >= beta ) {
+                break;
+            }
+        }
+    }
 
     return best_score;
 }
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <array>
 #include <cassert>
 #include <string>
 
+#if defined(__AVX512VBMI2__)
+#include <immintrin.h>
+#endif
+
 #include "definitions.h"
 
 // https://www.chessprogramming.org/Encoding_Moves
@@ -84,6 +89,8 @@ public:
 
 private:
     inline std::string_view idxToNotation(unsigned idx) const { return utils::square_to_coordinates.at(idx); }
+
+    friend struct MoveList;
 };
 
 constexpr PieceType Move::getPromotionPieceType() const
@@ -170,6 +177,27 @@ struct MoveList {
         }
     }
 
+    /**
+     * @brief   Adds a move with 'flag' from 'from' to every square of 'targets'.
+     *          Replaces a BIT_LOOP over add(), without its bounds check: a list holds more
+     *          moves than any position has.
+     */
+    template <Move::Flag flag>
+    inline void addTargets(int from, uint64_t targets)
+    {
+        addBulk(targets, (static_cast<uint16_t>(flag) << Move::FLAG_SHIFT) | (from << Move::FROM_SHIFT), 1);
+    }
+
+    /**
+     * @brief   Adds a move with 'flag' to every square of 'targets', each one coming from
+     *          the square 'offset' away. For pawns, which all move the same way.
+     */
+    template <Move::Flag flag, int offset>
+    inline void addShifted(uint64_t targets)
+    {
+        addBulk(targets, (static_cast<uint16_t>(flag) << Move::FLAG_SHIFT) + (offset << Move::FROM_SHIFT), (1 << Move::FROM_SHIFT) + 1);
+    }
+
     constexpr void remove(size_t index)
     {
         if ( index < count ) {
@@ -188,4 +216,59 @@ struct MoveList {
     constexpr Move* end() { return moves.data() + count; }
     constexpr const Move* begin() const { return moves.data(); }
     constexpr const Move* end() const { return moves.data() + count; }
+
+private:
+    /**
+     * @brief   Appends the move base + to * factor for every square 'to' of targets, in square order.
+     *          factor 1 only fills in the target square, factor 65 also puts it in the from field,
+     *          so a from offset in base turns into 'to + offset'.
+     *          With AVX-512 VBMI2 the moves of all 64 squares are computed at once and the ones
+     *          in targets are compressed to the front, otherwise one move per bit without a bounds check.
+     */
+    inline void addBulk(uint64_t targets, uint16_t base, uint16_t factor)
+    {
+        // skipping empty sets matters, count is a char and every store of a move forces it back to memory
+        if ( targets == 0ULL ) {
+            return;
+        }
+
+        Move* out = moves.data() + count;
+
+#if defined(__AVX512VBMI2__)
+        // compress into a register and store all 32 lanes, compress stores to memory are slow.
+        // only safe with enough room behind the last move, the scalar loop takes the rest
+        if ( static_cast<size_t>(count) + 64 <= moves.size() ) {
+            const __m512i base_vec = _mm512_set1_epi16(static_cast<short>(base));
+            const __m512i factor_vec = _mm512_set1_epi16(static_cast<short>(factor));
+            const auto low_targets = static_cast<__mmask32>(targets);
+            const auto high_targets = static_cast<__mmask32>(targets >> 32);
+
+            const __m512i low = _mm512_add_epi16(base_vec, _mm512_mullo_epi16(_mm512_load_si512(SQUARES.data()), factor_vec));
+            const __m512i high = _mm512_add_epi16(base_vec, _mm512_mullo_epi16(_mm512_load_si512(SQUARES.data() + 32), factor_vec));
+            _mm512_storeu_si512(out, _mm512_maskz_compress_epi16(low_targets, low));
+            _mm512_storeu_si512(out + __builtin_popcount(low_targets), _mm512_maskz_compress_epi16(high_targets, high));
+
+            count += __builtin_popcountll(targets);
+            return;
+        }
+#endif
+
+        count += __builtin_popcountll(targets);
+        for ( ; targets != 0ULL; targets &= targets - 1 ) {
+            *out++ = Move(static_cast<uint16_t>(base + __builtin_ctzll(targets) * factor));
+        }
+    }
+
+#if defined(__AVX512VBMI2__)
+    // the square indices as 16 bit lanes, the moves of all squares are computed from these
+    alignas(64) static constexpr std::array<uint16_t, 64> SQUARES = [] {
+        std::array<uint16_t, 64> squares {};
+        for ( uint16_t i = 0; i < 64; ++i ) {
+            squares[i] = i;
+        }
+        return squares;
+    }();
+#endif
 };
+
+static_assert(sizeof(Move) == sizeof(uint16_t), "MoveList::addBulk stores moves as raw 16 bit values");
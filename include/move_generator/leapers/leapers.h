@@ -15,13 +15,14 @@ inline std::array<u64, 64> king_attacks;
 
 class leapers {
 public:
-    template <Color color>
+    template <Color color, MoveType type = MoveType::all>
     static inline void knight(MoveList& move_list, const Board& board);
 
-    template <Color color>
+    template <Color color, MoveType type = MoveType::all>
     static inline void pawn(MoveList& move_list, const Board& board);
 
-    template <Color color>
+    // enemy_attacks is only needed for quiet moves and castling
+    template <Color color, MoveType type = MoveType::all>
     static inline void king(MoveList& move_list, const Board& board, u64 enemy_attacks);
 
     template <Color color>
@@ -4,7 +4,7 @@
 // MOVE GENERATION FUNCTIONS
 // ================================
 
-template <Color color>
+template <Color color, MoveType type>
 void leapers::pawn(MoveList& move_list, const Board& board)
 {
     constexpr bool is_white = utils::isWhite(color);
@@ -36,102 +36,51 @@ void leapers::pawn(MoveList& move_list, const Board& board)
     const uint64_t promo_capture_l = promotable_pawns & ~LEFT_FILE;
     const uint64_t promo_capture_r = promotable_pawns & ~RIGHT_FILE;
 
-    uint64_t quiet = pawnMove<color>(move_pawns, occupancy);
-    BIT_LOOP(quiet)
-    {
-        const uint64_t to = get_LSB(quiet);
-        const uint64_t from = to + OFFSET_MOVE;
-        move_list.add(Move::make<Move::Flag::quiet>(from, to));
+    if constexpr ( type == MoveType::all ) {
+        move_list.addShifted<Move::Flag::quiet, OFFSET_MOVE>(pawnMove<color>(move_pawns, occupancy));
+        move_list.addShifted<Move::Flag::pawn_push, OFFSET_PUSH>(pawnPush<color>(push_pawns, occupancy));
     }
 
-
-    uint64_t push = pawnPush<color>(push_pawns, occupancy);
-    BIT_LOOP(push)
-    {
-        const uint64_t to = get_LSB(push);
-        const uint64_t from = to + OFFSET_PUSH;
-        move_list.add(Move::make<Move::Flag::pawn_push>(from, to));
-    }
-
-
-    {
-        uint64_t left_ep = pawnAttackLeft<color>(attack_pawns_l, ep_field);
-        BIT_LOOP(left_ep)
-        {
-            const uint64_t to = get_LSB(left_ep);
-            const uint64_t from = to + OFFSET_ATTACK_L;
-            move_list.add(Move::make<Move::Flag::ep>(from, to));
-        }
-
-        uint64_t right_ep = pawnAttackRight<color>(attack_pawns_r, ep_field);
-        BIT_LOOP(right_ep)
-        {
-            const uint64_t to = get_LSB(right_ep);
-            const uint64_t from = to + OFFSET_ATTACK_R;
-            move_list.add(Move::make<Move::Flag::ep>(from, to));
-        }
+    if ( ep_field != 0ULL ) {
+        move_list.addShifted<Move::Flag::ep, OFFSET_ATTACK_L>(pawnAttackLeft<color>(attack_pawns_l, ep_field));
+        move_list.addShifted<Move::Flag::ep, OFFSET_ATTACK_R>(pawnAttackRight<color>(attack_pawns_r, ep_field));
     }
 
+    move_list.addShifted<Move::Flag::capture, OFFSET_ATTACK_L>(pawnAttackLeft<color>(attack_pawns_l, enemy));
+    move_list.addShifted<Move::Flag::capture, OFFSET_ATTACK_R>(pawnAttackRight<color>(attack_pawns_r, enemy));
 
-    {
-        uint64_t left_attacks = pawnAttackLeft<color>(attack_pawns_l, enemy);
-        BIT_LOOP(left_attacks)
-        {
-            const uint64_t to = get_LSB(left_attacks);
-            const uint64_t from = to + OFFSET_ATTACK_L;
-            move_list.add(Move::make<Move::Flag::capture>(from, to));
-        }
-
-        uint64_t right_attacks = pawnAttackRight<color>(attack_pawns_r, enemy);
-        BIT_LOOP(right_attacks)
-        {
-            const uint64_t to = get_LSB(right_attacks);
-            const uint64_t from = to + OFFSET_ATTACK_R;
-            move_list.add(Move::make<Move::Flag::capture>(from, to));
+    if constexpr ( type == MoveType::captures ) {
+        if ( promotable_pawns != 0ULL ) {
+            move_list.addShifted<Move::Flag::promo_q, OFFSET_MOVE>(pawnMove<color>(promotable_pawns, occupancy));
+            move_list.addShifted<Move::Flag::promo_x_q, OFFSET_ATTACK_L>(pawnAttackLeft<color>(promo_capture_l, enemy));
+            move_list.addShifted<Move::Flag::promo_x_q, OFFSET_ATTACK_R>(pawnAttackRight<color>(promo_capture_r, enemy));
         }
+        return;
     }
 
+    // every promotion is added four times, so skip all of them at once if there are no pawns to promote
+    if ( promotable_pawns != 0ULL ) {
+        const uint64_t quiet_promo = pawnMove<color>(promotable_pawns, occupancy);
+        move_list.addShifted<Move::Flag::promo_n, OFFSET_MOVE>(quiet_promo);
+        move_list.addShifted<Move::Flag::promo_b, OFFSET_MOVE>(quiet_promo);
+        move_list.addShifted<Move::Flag::promo_r, OFFSET_MOVE>(quiet_promo);
+        move_list.addShifted<Move::Flag::promo_q, OFFSET_MOVE>(quiet_promo);
 
-    {
-        uint64_t quiet_promo = pawnMove<color>(promotable_pawns, occupancy);
-        BIT_LOOP(quiet_promo)
-        {
-            const uint64_t to = get_LSB(quiet_promo);
-            const uint64_t from = to + OFFSET_MOVE;
-
-            move_list.add(Move::make<Move::Flag::promo_n>(from, to));
-            move_list.add(Move::make<Move::Flag::promo_b>(from, to));
-            move_list.add(Move::make<Move::Flag::promo_r>(from, to));
-            move_list.add(Move::make<Move::Flag::promo_q>(from, to));
-        }
+        const uint64_t capture_left_promo = pawnAttackLeft<color>(promo_capture_l, enemy);
+        move_list.addShifted<Move::Flag::promo_x_n, OFFSET_ATTACK_L>(capture_left_promo);
+        move_list.addShifted<Move::Flag::promo_x_b, OFFSET_ATTACK_L>(capture_left_promo);
+        move_list.addShifted<Move::Flag::promo_x_r, OFFSET_ATTACK_L>(capture_left_promo);
+        move_list.addShifted<Move::Flag::promo_x_q, OFFSET_ATTACK_L>(capture_left_promo);
 
-        uint64_t capture_left_promo = pawnAttackLeft<color>(promo_capture_l, enemy);
-        BIT_LOOP(capture_left_promo)
-        {
-            const uint64_t to = get_LSB(capture_left_promo);
-            const uint64_t from = to + OFFSET_ATTACK_L;
-
-            move_list.add(Move::make<Move::Flag::promo_x_n>(from, to));
-            move_list.add(Move::make<Move::Flag::promo_x_b>(from, to));
-            move_list.add(Move::make<Move::Flag::promo_x_r>(from, to));
-            move_list.add(Move::make<Move::Flag::promo_x_q>(from, to));
-        }
-
-        uint64_t capture_right_promo = pawnAttackRight<color>(promo_capture_r, enemy);
-        BIT_LOOP(capture_right_promo)
-        {
-            const uint64_t to = get_LSB(capture_right_promo);
-            const uint64_t from = to + OFFSET_ATTACK_R;
-
-            move_list.add(Move::make<Move::Flag::promo_x_n>(from, to));
-            move_list.add(Move::make<Move::Flag::promo_x_b>(from, to));
-            move_list.add(Move::make<Move::Flag::promo_x_r>(from, to));
-            move_list.add(Move::make<Move::Flag::promo_x_q>(from, to));
-        }
+        const uint64_t capture_right_promo = pawnAttackRight<color>(promo_capture_r, enemy);
+        move_list.addShifted<Move::Flag::promo_x_n, OFFSET_ATTACK_R>(capture_right_promo);
+        move_list.addShifted<Move::Flag::promo_x_b, OFFSET_ATTACK_R>(capture_right_promo);
+        move_list.addShifted<Move::Flag::promo_x_r, OFFSET_ATTACK_R>(capture_right_promo);
+        move_list.addShifted<Move::Flag::promo_x_q, OFFSET_ATTACK_R>(capture_right_promo);
     }
 }
 
-template <Color color>
+template <Color color, MoveType type>
 void leapers::knight(MoveList& move_list, const Board& board)
 {
     const uint64_t occupancy = board.getOccupancy();
@@ -142,23 +91,14 @@ void leapers::knight(MoveList& move_list, const Board& board)
     {
         const uint64_t from = get_LSB(knights);
 
-        uint64_t move_targets = knight_attacks[from] & ~occupancy;
-        BIT_LOOP(move_targets)
-        {
-            const uint64_t to = get_LSB(move_targets);
-            move_list.add(Move::make<Move::Flag::quiet>(from, to));
-        }
-
-        uint64_t attack_targets = knight_attacks[from] & enemy;
-        BIT_LOOP(attack_targets)
-        {
-            const uint64_t to = get_LSB(attack_targets);
-            move_list.add(Move::make<Move::Flag::capture>(from, to));
+        if constexpr ( type == MoveType::all ) {
+            move_list.addTargets<Move::Flag::quiet>(from, knight_attacks[from] & ~occupancy);
         }
+        move_list.addTargets<Move::Flag::capture>(from, knight_attacks[from] & enemy);
     }
 }
 
-template <Color color>
+template <Color color, MoveType type>
 void leapers::king(MoveList& move_list, const Board& board, uint64_t enemy_attacks)
 {
     const uint64_t occupancy = board.getOccupancy();
@@ -167,19 +107,12 @@ void leapers::king(MoveList& move_list, const Board& board, uint64_t enemy_attac
     uint64_t king = board.getPieces<PieceType::king, color>();
     const uint64_t from = get_LSB(king);
 
-    uint64_t moves = king_attacks[from] & ~occupancy & ~enemy_attacks;
-    BIT_LOOP(moves)
-    {
-        const uint64_t to = get_LSB(moves);
-        move_list.add(Move::make<Move::Flag::quiet>(from, to));
+    move_list.addTargets<Move::Flag::capture>(from, king_attacks[from] & enemy);
+    if constexpr ( type == MoveType::captures ) {
+        return;
     }
 
-    uint64_t attacks = king_attacks[from] & enemy;
-    BIT_LOOP(attacks)
-    {
-        const uint64_t to = get_LSB(attacks);
-        move_list.add(Move::make<Move::Flag::capture>(from, to));
-    }
+    move_list.addTargets<Move::Flag::quiet>(from, king_attacks[from] & ~occupancy & ~enemy_attacks);
 
     if ( board.canCastleKs<color>(enemy_attacks) ) {
         move_list.add(Move::make<Move::Flag::castle_k>(from, from + 2));
@@ -31,7 +31,6 @@ inline void initializePrecomputedStuff()
 {
     magic::initMagics();
     leapers::initLeapers();
-    Zobrist::initialize();
 }
 
 /**
@@ -39,26 +38,28 @@ inline void initializePrecomputedStuff()
  *                      even illegal ones. We will filter the list later.
  *
  * @tparam color        Player for whom we are generating moves
+ * @tparam type         all moves, or only the ones that change the material (see MoveType)
  * @param move_list     A container that can store our generated moves
  * @param board         The current board representation
  */
-template <Color color>
+template <Color color, MoveType type = MoveType::all>
 inline u64 pseudolegal_moves(MoveList& move_list, const Board& board)
 {
-    const u64 enemy_attacks = generate_attacks<utils::switchColor(color)>(board);
+    // the king only needs them for quiet moves and castling
+    const u64 enemy_attacks = (type == MoveType::all) ? generate_attacks<utils::switchColor(color)>(board) : 0ULL;
 
-    leapers::pawn<color>(move_list, board);
-    leapers::knight<color>(move_list, board);
-    leapers::king<color>(move_list, board, enemy_attacks);
+    leapers::pawn<color, type>(move_list, board);
+    leapers::knight<color, type>(move_list, board);
+    leapers::king<color, type>(move_list, board, enemy_attacks);
 
-    sliders::generateMoves<PieceType::bishop, color>(move_list, board);
-    sliders::generateMoves<PieceType::rook, color>(move_list, board);
-    sliders::generateMoves<PieceType::queen, color>(move_list, board);
+    sliders::generateMoves<PieceType::bishop, color, type>(move_list, board);
+    sliders::generateMoves<PieceType::rook, color, type>(move_list, board);
+    sliders::generateMoves<PieceType::queen, color, type>(move_list, board);
 
     return move_list.size();
 }
 
-template <Color color>
+template <Color color, MoveType type = MoveType::all>
 inline u64 generate_moves(MoveList& move_list, Board& board)
 {
 
@@ -85,7 +86,7 @@ inline u64 generate_moves(MoveList& move_list, Board& board)
         if not we.. could maybe filter for possible blockers but idk how
 */
 
-    pseudolegal_moves<color>(move_list, board);
+    pseudolegal_moves<color, type>(move_list, board);
 
     for ( size_t i = 0; i < move_list.size(); ) {
         board.move<color>(move_list[i]);
@@ -136,3 +137,38 @@ inline u64 generate_attacks(const Board& board)
 
     return attacks;
 }
+
+/**
+ * @brief   Pieces of 'color' that give check to the enemy king. Only looks at the lines
+ *          through the king square instead of generating all attacks, so it is cheap enough
+ *          to run after every move.
+ *
+ * @tparam color        color of the side that could be giving check
+ * @param board         a board
+ * @return u64          the checking pieces
+ */
+template <Color color>
+inline u64 generate_checkers(const Board& board)
+{
+    constexpr Color enemy_color = utils::switchColor(color);
+
+    const u64 king = board.getPieces<PieceType::king, enemy_color>();
+    if ( king == 0ULL ) {
+        return 0ULL;
+    }
+
+    const int square = get_LSB(king);
+    const u64 occupancy = board.getOccupancy();
+
+    const u64 queens = board.getPieces<PieceType::queen, color>();
+    const u64 diagonal = board.getPieces<PieceType::bishop, color>() | queens;
+    const u64 straight = board.getPieces<PieceType::rook, color>() | queens;
+
+    // a pawn of 'color' attacks the king if it stands where an enemy pawn on the king square would attack
+    const u64 pawn_squares = utils::isWhite(color) ? black_pawn_attacks[square] : white_pawn_attacks[square];
+
+    return (sliders::getBitboard<PieceType::bishop>(king, occupancy) & diagonal)
+        | (sliders::getBitboard<PieceType::rook>(king, occupancy) & straight)
+        | (knight_attacks[square] & board.getPieces<PieceType::knight, color>())
+        | (pawn_squares & board.getPieces<PieceType::pawn, color>());
+}
@@ -7,16 +7,18 @@
 
 class sliders {
 public:
-    template <PieceType type, Color color>
+    template <PieceType type, Color color, MoveType move_type = MoveType::all>
     static void generateMoves(MoveList& move_list, const Board& board);
 
     template <PieceType type>
     static inline u64 getBitboard(u64 pieces, u64 occupancy);
 
-private:
+    // attacks of a bishop or rook on square, public for the microbenchmarks
     template <PieceType type>
     static inline u64 getSquareMagic(u64 occupancy, int square);
 
+private:
+
     template <PieceType type>
     static inline u64 getPossibleMoves(u64 pieces, u64 occupancy);
 };
@@ -2,7 +2,7 @@
 
 #include "sliders.h"
 
-template <PieceType type, Color color>
+template <PieceType type, Color color, MoveType move_type>
 void sliders::generateMoves(MoveList& move_list, const Board& board)
 {
     static_assert(type == PieceType::bishop || type == PieceType::rook || type == PieceType::queen);
@@ -16,18 +16,9 @@ void sliders::generateMoves(MoveList& move_list, const Board& board)
         const uint64_t from = get_LSB(pieces);
         const uint64_t potential_moves = getBitboard<type>((1ULL << from), occupancy);
 
-        uint64_t attacks = potential_moves & enemy;
-        BIT_LOOP(attacks)
-        {
-            const uint64_t to = get_LSB(attacks);
-            move_list.add(Move::make<Move::Flag::capture>(from, to));
-        }
-
-        uint64_t moves = potential_moves & ~occupancy;
-        BIT_LOOP(moves)
-        {
-            const uint64_t to = get_LSB(moves);
-            move_list.add(Move::make<Move::Flag::quiet>(from, to));
+        move_list.addTargets<Move::Flag::capture>(from, potential_moves & enemy);
+        if constexpr ( move_type == MoveType::all ) {
+            move_list.addTargets<Move::Flag::quiet>(from, potential_moves & ~occupancy);
         }
     }
 }
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief   Reproducible perft benchmark. A fixed set of positions is counted on a single
+ *          thread pinned to one cpu, every position with a few discarded warmup runs and
+ *          then 'repetitions' timed runs, each with fresh tables.
+ *          Results are written as JSON together with the git revision and the build flags,
+ *          compare() reads two such files and tells which differences are significant.
+ */
+namespace bench {
+    struct Position {
+        std::string name;
+        std::string fen;
+        int depth = 0;
+
+        uint64_t nodes = 0;
+        std::vector<double> nps;    // one sample per timed run
+
+        double min() const;
+        double median() const;
+        double mean() const;
+        double stddev() const;      // sample standard deviation
+    };
+
+    struct Settings {
+        int repetitions = 5;
+        int warmup = 1;
+        int cpu = -1;               // -1: the cpu the process is running on when the benchmark starts
+    };
+
+    struct Result {
+        std::string git_hash;
+        std::string build_flags;
+        int cpu = -1;               // -1 if pinning is not supported or failed
+        Settings settings;
+        std::vector<Position> positions;
+    };
+
+    // the positions every benchmark runs, so results of different builds can be compared
+    std::vector<Position> defaultPositions();
+
+    Result run(const Settings& settings, std::ostream& progress);
+
+    void print(const Result& result, std::ostream& os);
+    void writeJson(const Result& result, std::ostream& os);
+
+    /**
+     * @brief   Reads the name and the nps samples of every position of a JSON file written by writeJson.
+     *          Throws std::runtime_error if the file can not be read.
+     */
+    Result readJson(const std::string& path);
+
+    /**
+     * @brief   Welch's t-test on the nps samples of every position both results have.
+     *          A difference is reported as significant if p < alpha.
+     */
+    void compare(const Result& base, const Result& candidate, double alpha, std::ostream& os);
+}; // namespace bench
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+class Game; // fwd declaration
+
+/**
+ * @brief   Resumable perft. The tree is cut into units, the subtrees of the root moves
+ *          or of the second ply, and the count of every finished unit is appended to a
+ *          journal file right away. Started again with the same journal, only the units
+ *          that are not in it yet are counted.
+ *
+ *          journal format:
+ *              slou-perft-journal <version> <depth> <unit ply> <fen>
+ *              <move> [<move>] <nodes>
+ *              ...
+ */
+namespace journal {
+    constexpr int VERSION = 1;
+
+    /**
+     * @brief   Counts all units that are missing in the journal, on 'threads' threads that share
+     *          the tables of 'game', and prints the progress with an estimate of the remaining time.
+     *          Throws std::runtime_error if the journal belongs to another run or can not be written.
+     *
+     * @param unit_ply  1: a unit per root move, 2: a unit per reply to a root move
+     * @return          node count below every root move
+     */
+    std::vector<std::pair<std::string, uint64_t>> run(Game& game, const std::string& fen, int depth, int unit_ply, const std::string& path, int threads);
+}; // namespace journal
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+class Game; // fwd declaration
+
+/**
+ * @brief   Distributed perft for jobs that can not talk to each other.
+ *
+ *          split:  expands the root position k plies deep and writes the unique positions on
+ *                  that ply to a manifest, spread over a number of shards. Transpositions are
+ *                  merged by zobrist key, every position remembers how often it is reached
+ *                  below each root move.
+ *          count:  counts the positions of one shard and appends each result to the result file
+ *                  of the shard as soon as it is known, so a killed job continues where it
+ *                  stopped when it is started again.
+ *          merge:  sums the result files of all shards, weighted by the multiplicities.
+ */
+namespace shards {
+    struct Position {
+        size_t shard = 0;
+        uint64_t key = 0;
+        std::map<size_t, uint64_t> roots;   // root move index -> number of paths to this position
+        std::string fen;
+    };
+
+    struct Manifest {
+        static constexpr int VERSION = 1;
+
+        std::string fen;
+        int depth = 0;
+        int split_ply = 0;
+        size_t shard_count = 0;
+        std::vector<std::string> root_moves;
+        std::vector<Position> positions;
+
+        // depth that is left to count below each position
+        int remainingDepth() const { return depth - split_ply; }
+    };
+
+    /**
+     * @brief   Expands fen split_ply plies deep. Throws std::runtime_error on invalid arguments.
+     */
+    Manifest split(const std::string& fen, int depth, int split_ply, size_t shard_count);
+
+    void write(const Manifest& manifest, const std::string& path);
+    Manifest read(const std::string& path);
+
+    // result file of one shard, next to the manifest
+    std::string resultPath(const std::string& manifest_path, size_t shard);
+
+    /**
+     * @brief   Counts every position of the shard that is not in its result file yet.
+     *
+     * @return uint64_t number of positions that were counted by this call
+     */
+    uint64_t count(const Manifest& manifest, const std::string& manifest_path, size_t shard, Game& game, int threads);
+
+    /**
+     * @brief   Node count below every root move, in the order of Manifest::root_moves.
+     *          Throws std::runtime_error if a shard is missing or not finished yet.
+     */
+    std::vector<uint64_t> merge(const Manifest& manifest, const std::string& manifest_path);
+}; // namespace shards
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+
+#include "bitboard.h"
+#include "definitions.h"
+#include "board/board.h"
+
+/**
+ * @brief   Experimental leaf counter for perft. Instead of generating and checking the moves of
+ *          every leaf on its own, up to LANES sibling positions are packed into the lanes of
+ *          a vector and their legal moves are counted together, without building move lists.
+ *
+ *          Slider attacks are Kogge-Stone fills per direction instead of magic lookups, so the
+ *          whole counter is shifts, masks and popcounts that run the same way in every lane.
+ *          A target square is reached by at most one slider per direction (and by at most one
+ *          knight per jump), so the per direction popcounts add up to the exact move count.
+ *          Pinned pieces may only move along the line of their pin, en passant is the one case
+ *          that is checked per lane with scalar code, as it can uncover a check along a rank.
+ *
+ *          Uses AVX-512 (8 lanes) or AVX2 (4 lanes) if the compiler targets them, otherwise
+ *          2 lane vectors. Wider vectors than the target has registers for would be passed
+ *          differently between functions (gcc -Wpsabi). Enabled in perft with ENABLE_SIMD_LEAVES (cmake -DSLOU_SIMD_LEAVES=ON).
+ */
+namespace simd_leaves {
+#if defined(__AVX512F__)
+    constexpr int LANES = 8;
+#elif defined(__AVX2__)
+    constexpr int LANES = 4;
+#else
+    constexpr int LANES = 2;
+#endif
+
+    typedef uint64_t Vec __attribute__((vector_size(LANES * sizeof(uint64_t))));
+
+    /**
+     * @brief   Positions with the same color to move, one per lane. Unused lanes are empty
+     *          boards, which have no moves.
+     */
+    struct Batch {
+        // pieces of the color to move
+        Vec pawns {}, knights {}, bishops {}, rooks {}, queens {}, king {};
+        // pieces of the other color
+        Vec enemy_pawns {}, enemy_knights {}, enemy_bishops {}, enemy_rooks {}, enemy_queens {}, enemy_king {};
+
+        Vec ep_field {};
+        Vec castling {};    // Board::getRawCastlingRights
+
+        int size = 0;
+
+        constexpr bool full() const { return size == LANES; }
+        constexpr bool empty() const { return size == 0; }
+        void clear() { *this = Batch(); }
+
+        // puts board into the next free lane, color has to be the color to move on board
+        template <Color color> void add(const Board& board);
+    };
+
+    // number of legal moves in every lane
+    template <Color color> Vec countLanes(const Batch& batch);
+
+    // number of legal moves of all positions in the batch
+    template <Color color> uint64_t count(const Batch& batch);
+}; // namespace simd_leaves
+
+#include "simd_leaves.hpp"
@@ -0,0 +1,300 @@
+#pragma once
+
+#if defined(__AVX512VPOPCNTDQ__)
+#include <immintrin.h>
+#endif
+
+#include "simd_leaves.h"
+#include "move_generator/move_generation.h"
+
+namespace simd_leaves {
+    namespace detail {
+        inline Vec nonzero(Vec v) { return (Vec) (v != 0); }   // all ones in lanes that are not 0
+
+        inline Vec popcount(Vec v)
+        {
+#if defined(__AVX512VPOPCNTDQ__)
+            return (Vec) _mm512_popcnt_epi64((__m512i) v);
+#else
+            Vec result;
+            for ( int i = 0; i < LANES; ++i ) {
+                result[i] = get_bit_count(v[i]);
+            }
+            return result;
+#endif
+        }
+
+        // squares a shift by dir can land on without wrapping around the board
+        template <int dir>
+        constexpr uint64_t wrapMask()
+        {
+            if constexpr ( dir == East || dir == NorthEast || dir == SouthEast ) return ~FILE_A;
+            else if constexpr ( dir == West || dir == NorthWest || dir == SouthWest ) return ~FILE_H;
+            else return FULL_BB;
+        }
+
+        // shift by 'offset' squares, the result is masked with 'mask'
+        template <int offset, uint64_t mask>
+        inline Vec jump(Vec b)
+        {
+            if constexpr ( offset > 0 ) return (b << offset) & mask;
+            else return (b >> -offset) & mask;
+        }
+
+        template <int dir>
+        inline Vec step(Vec b) { return jump<dir, wrapMask<dir>()>(b); }
+
+        // all squares the pieces in gen reach in direction dir over empty squares, gen included
+        template <int dir>
+        inline Vec occludedFill(Vec gen, Vec empty)
+        {
+            empty &= wrapMask<dir>();
+            gen |= empty & jump<dir, FULL_BB>(gen);
+            empty &= jump<dir, FULL_BB>(empty);
+            gen |= empty & jump<2 * dir, FULL_BB>(gen);
+            empty &= jump<2 * dir, FULL_BB>(empty);
+            gen |= empty & jump<4 * dir, FULL_BB>(gen);
+            return gen;
+        }
+
+        // attacks of the sliders in direction dir, up to and including the first blocker
+        template <int dir>
+        inline Vec slide(Vec sliders, Vec empty) { return step<dir>(occludedFill<dir>(sliders, empty)); }
+
+        // 0: file, 1: rank, 2: diagonal, 3: anti diagonal
+        template <int dir>
+        constexpr int line()
+        {
+            if constexpr ( dir == North || dir == South ) return 0;
+            else if constexpr ( dir == East || dir == West ) return 1;
+            else if constexpr ( dir == NorthEast || dir == SouthWest ) return 2;
+            else return 3;
+        }
+
+        inline Vec knightAttacks(Vec knights)
+        {
+            return jump<17, ~FILE_A>(knights) | jump<15, ~FILE_H>(knights)
+                | jump<10, ~FILE_AB>(knights) | jump<6, ~FILE_GH>(knights)
+                | jump<-6, ~FILE_AB>(knights) | jump<-10, ~FILE_GH>(knights)
+                | jump<-15, ~FILE_A>(knights) | jump<-17, ~FILE_H>(knights);
+        }
+
+        inline Vec kingAttacks(Vec king)
+        {
+            return step<North>(king) | step<South>(king) | step<East>(king) | step<West>(king)
+                | step<NorthEast>(king) | step<NorthWest>(king) | step<SouthEast>(king) | step<SouthWest>(king);
+        }
+
+        template <Color color>
+        inline Vec pawnAttacks(Vec pawns)
+        {
+            if constexpr ( utils::isWhite(color) ) return step<NorthEast>(pawns) | step<NorthWest>(pawns);
+            else return step<SouthEast>(pawns) | step<SouthWest>(pawns);
+        }
+
+        template <int dir>
+        inline Vec straightOrDiagonal(Vec straight, Vec diagonal)
+        {
+            if constexpr ( line<dir>() < 2 ) return straight;
+            else return diagonal;
+        }
+
+        /**
+         * @brief   Looks from the king in direction dir: an enemy slider as the first piece
+         *          gives check, an own piece with an enemy slider behind it is pinned.
+         */
+        template <int dir>
+        inline void kingRay(Vec king, Vec own, Vec empty, Vec enemy_sliders,
+                            Vec& checkers, Vec& check_rays, Vec& pinned)
+        {
+            const Vec ray = slide<dir>(king, empty);
+            const Vec checker = ray & enemy_sliders;
+            checkers |= checker;
+            check_rays |= ray & nonzero(checker);
+
+            const Vec blocker = ray & own;
+            pinned |= blocker & nonzero(slide<dir>(blocker, empty) & enemy_sliders);
+        }
+
+        template <int dir>
+        inline Vec slidingMoves(Vec straight, Vec diagonal, const Vec (&movable)[4], Vec empty, Vec targets)
+        {
+            const Vec sliders = straightOrDiagonal<dir>(straight, diagonal) & movable[line<dir>()];
+            return popcount(slide<dir>(sliders, empty) & targets);
+        }
+
+        template <int offset, uint64_t mask>
+        inline Vec knightMoves(Vec knights, Vec targets) { return popcount(jump<offset, mask>(knights) & targets); }
+
+        // pawn moves to targets, moves to the last rank count once per promotion piece
+        template <Color color>
+        inline Vec pawnMoves(Vec targets)
+        {
+            constexpr uint64_t PROMO_RANK = utils::isWhite(color) ? RANK_8 : RANK_1;
+            return popcount(targets & ~PROMO_RANK) + (popcount(targets & PROMO_RANK) << 2);
+        }
+
+        /**
+         * @brief   En passant captures of one lane. The captured pawn and the capturing one leave
+         *          the same rank at once, so the only reliable test is to look for attacks on the
+         *          king with the occupancy after the capture.
+         */
+        template <Color color>
+        inline uint64_t enPassant(uint64_t ep_field, uint64_t pawns, uint64_t king, uint64_t occupancy,
+                                  uint64_t enemy_straight, uint64_t enemy_diagonal, uint64_t enemy_knights, uint64_t enemy_pawns)
+        {
+            constexpr Color enemy_color = utils::switchColor(color);
+            const uint64_t captured = utils::isWhite(color) ? south(ep_field) : north(ep_field);
+            const int king_square = get_LSB(king);
+            const uint64_t pawn_checkers = utils::isWhite(color) ? white_pawn_attacks[king_square] : black_pawn_attacks[king_square];
+
+            uint64_t count = 0ULL;
+            uint64_t capturers = leapers::getPawnAttackMask<enemy_color>(ep_field) & pawns;
+            BIT_LOOP(capturers)
+            {
+                const uint64_t after = (occupancy ^ (capturers & -capturers) ^ captured) | ep_field;
+                const uint64_t attackers = (sliders::getBitboard<PieceType::rook>(king, after) & enemy_straight)
+                    | (sliders::getBitboard<PieceType::bishop>(king, after) & enemy_diagonal)
+                    | (knight_attacks[king_square] & enemy_knights)
+                    | (pawn_checkers & enemy_pawns & ~captured);
+
+                count += (attackers == 0ULL);
+            }
+
+            return count;
+        }
+    }; // namespace detail
+
+    template <Color color>
+    void Batch::add(const Board& board)
+    {
+        constexpr Color enemy_color = utils::switchColor(color);
+        const int lane = size++;
+
+        pawns[lane] = board.getPieces<PieceType::pawn, color>();
+        knights[lane] = board.getPieces<PieceType::knight, color>();
+        bishops[lane] = board.getPieces<PieceType::bishop, color>();
+        rooks[lane] = board.getPieces<PieceType::rook, color>();
+        queens[lane] = board.getPieces<PieceType::queen, color>();
+        king[lane] = board.getPieces<PieceType::king, color>();
+
+        enemy_pawns[lane] = board.getPieces<PieceType::pawn, enemy_color>();
+        enemy_knights[lane] = board.getPieces<PieceType::knight, enemy_color>();
+        enemy_bishops[lane] = board.getPieces<PieceType::bishop, enemy_color>();
+        enemy_rooks[lane] = board.getPieces<PieceType::rook, enemy_color>();
+        enemy_queens[lane] = board.getPieces<PieceType::queen, enemy_color>();
+        enemy_king[lane] = board.getPieces<PieceType::king, enemy_color>();
+
+        ep_field[lane] = board.getEpField();
+        castling[lane] = static_cast<unsigned char>(board.getRawCastlingRights());
+    }
+
+    template <Color color>
+    Vec countLanes(const Batch& b)
+    {
+        using namespace detail;
+
+        constexpr bool is_white = utils::isWhite(color);
+        constexpr int UP = is_white ? North : South;
+        constexpr int UP_LEFT = is_white ? NorthWest : SouthWest;
+        constexpr int UP_RIGHT = is_white ? NorthEast : SouthEast;
+        constexpr uint64_t DOUBLE_PUSH_RANK = is_white ? RANK_3 : RANK_6;   // where the first step of a double push lands
+        constexpr uint64_t CASTLE_KS = is_white ? Board::CASTLE_WK : Board::CASTLE_BK;
+        constexpr uint64_t CASTLE_QS = is_white ? Board::CASTLE_WQ : Board::CASTLE_BQ;
+        constexpr uint64_t KS_EMPTY = is_white ? 0x60ULL : 0x60ULL << 56;
+        constexpr uint64_t KS_SAFE = is_white ? 0x70ULL : 0x70ULL << 56;
+        constexpr uint64_t QS_EMPTY = is_white ? 0xEULL : 0xEULL << 56;
+        constexpr uint64_t QS_SAFE = is_white ? 0x1CULL : 0x1CULL << 56;
+
+        const Vec own = b.pawns | b.knights | b.bishops | b.rooks | b.queens | b.king;
+        const Vec enemy = b.enemy_pawns | b.enemy_knights | b.enemy_bishops | b.enemy_rooks | b.enemy_queens | b.enemy_king;
+        const Vec occupancy = own | enemy;
+        const Vec empty = ~occupancy;
+
+        const Vec straight = b.rooks | b.queens;
+        const Vec diagonal = b.bishops | b.queens;
+        const Vec enemy_straight = b.enemy_rooks | b.enemy_queens;
+        const Vec enemy_diagonal = b.enemy_bishops | b.enemy_queens;
+
+        // squares the enemy attacks, the king must not block the rays it would move along
+        const Vec empty_without_king = empty | b.king;
+        const Vec attacked = pawnAttacks<utils::switchColor(color)>(b.enemy_pawns)
+            | knightAttacks(b.enemy_knights) | kingAttacks(b.enemy_king)
+            | slide<North>(enemy_straight, empty_without_king) | slide<South>(enemy_straight, empty_without_king)
+            | slide<East>(enemy_straight, empty_without_king) | slide<West>(enemy_straight, empty_without_king)
+            | slide<NorthEast>(enemy_diagonal, empty_without_king) | slide<NorthWest>(enemy_diagonal, empty_without_king)
+            | slide<SouthEast>(enemy_diagonal, empty_without_king) | slide<SouthWest>(enemy_diagonal, empty_without_king);
+
+        Vec checkers = (knightAttacks(b.king) & b.enemy_knights) | (pawnAttacks<color>(b.king) & b.enemy_pawns);
+        Vec check_rays {};
+        Vec pinned[4] = {};
+        kingRay<North>(b.king, own, empty, enemy_straight, checkers, check_rays, pinned[line<North>()]);
+        kingRay<South>(b.king, own, empty, enemy_straight, checkers, check_rays, pinned[line<South>()]);
+        kingRay<East>(b.king, own, empty, enemy_straight, checkers, check_rays, pinned[line<East>()]);
+        kingRay<West>(b.king, own, empty, enemy_straight, checkers, check_rays, pinned[line<West>()]);
+        kingRay<NorthEast>(b.king, own, empty, enemy_diagonal, checkers, check_rays, pinned[line<NorthEast>()]);
+        kingRay<NorthWest>(b.king, own, empty, enemy_diagonal, checkers, check_rays, pinned[line<NorthWest>()]);
+        kingRay<SouthEast>(b.king, own, empty, enemy_diagonal, checkers, check_rays, pinned[line<SouthEast>()]);
+        kingRay<SouthWest>(b.king, own, empty, enemy_diagonal, checkers, check_rays, pinned[line<SouthWest>()]);
+
+        // not in check: anywhere, single check: capture or block, double check: only the king moves
+        const Vec in_check = nonzero(checkers);
+        const Vec double_check = nonzero(checkers & (checkers - 1));
+        const Vec check_mask = ((check_rays | checkers) | ~in_check) & ~double_check;
+
+        // a pinned piece may only move along the line of its pin
+        const Vec pinned_any = pinned[0] | pinned[1] | pinned[2] | pinned[3];
+        const Vec movable[4] = { ~pinned_any | pinned[0], ~pinned_any | pinned[1], ~pinned_any | pinned[2], ~pinned_any | pinned[3] };
+
+        const Vec targets = ~own & check_mask;
+
+        Vec nodes = slidingMoves<North>(straight, diagonal, movable, empty, targets)
+            + slidingMoves<South>(straight, diagonal, movable, empty, targets)
+            + slidingMoves<East>(straight, diagonal, movable, empty, targets)
+            + slidingMoves<West>(straight, diagonal, movable, empty, targets)
+            + slidingMoves<NorthEast>(straight, diagonal, movable, empty, targets)
+            + slidingMoves<NorthWest>(straight, diagonal, movable, empty, targets)
+            + slidingMoves<SouthEast>(straight, diagonal, movable, empty, targets)
+            + slidingMoves<SouthWest>(straight, diagonal, movable, empty, targets);
+
+        const Vec knights = b.knights & ~pinned_any;
+        nodes += knightMoves<17, ~FILE_A>(knights, targets) + knightMoves<15, ~FILE_H>(knights, targets)
+            + knightMoves<10, ~FILE_AB>(knights, targets) + knightMoves<6, ~FILE_GH>(knights, targets)
+            + knightMoves<-6, ~FILE_AB>(knights, targets) + knightMoves<-10, ~FILE_GH>(knights, targets)
+            + knightMoves<-15, ~FILE_A>(knights, targets) + knightMoves<-17, ~FILE_H>(knights, targets);
+
+        const Vec single_push = step<UP>(b.pawns & movable[line<UP>()]) & empty;
+        const Vec double_push = step<UP>(single_push & DOUBLE_PUSH_RANK) & empty;
+        nodes += pawnMoves<color>(single_push & check_mask) + popcount(double_push & check_mask)
+            + pawnMoves<color>(step<UP_LEFT>(b.pawns & movable[line<UP_LEFT>()]) & enemy & check_mask)
+            + pawnMoves<color>(step<UP_RIGHT>(b.pawns & movable[line<UP_RIGHT>()]) & enemy & check_mask);
+
+        nodes += popcount(kingAttacks(b.king) & ~own & ~attacked);
+
+        // castling never happens in check, the king square is part of the safe squares
+        const Vec king_side = nonzero(b.castling & CASTLE_KS) & ~nonzero(occupancy & KS_EMPTY) & ~nonzero(attacked & KS_SAFE);
+        const Vec queen_side = nonzero(b.castling & CASTLE_QS) & ~nonzero(occupancy & QS_EMPTY) & ~nonzero(attacked & QS_SAFE);
+        nodes += (king_side & 1) + (queen_side & 1);
+
+        for ( int i = 0; i < b.size; ++i ) {
+            if ( b.ep_field[i] != 0ULL ) {
+                nodes[i] += enPassant<color>(b.ep_field[i], b.pawns[i], b.king[i], occupancy[i],
+                                             enemy_straight[i], enemy_diagonal[i], b.enemy_knights[i], b.enemy_pawns[i]);
+            }
+        }
+
+        return nodes;
+    }
+
+    template <Color color>
+    uint64_t count(const Batch& batch)
+    {
+        const Vec nodes = countLanes<color>(batch);
+
+        uint64_t sum = 0ULL;
+        for ( int i = 0; i < LANES; ++i ) {
+            sum += nodes[i];
+        }
+        return sum;
+    }
+}; // namespace simd_leaves
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+/**
+ * @brief   Node count of a perft split into the categories of the usual perft result tables.
+ *          Every category counts moves of the last ply. As in those tables a double check
+ *          only counts as double check, a single check is discovered if the checking piece
+ *          is not the one that moved.
+ */
+struct PerftStats {
+    uint64_t nodes = 0;
+    uint64_t captures = 0;          // including en passant and capturing promotions
+    uint64_t en_passants = 0;
+    uint64_t castles = 0;
+    uint64_t promotions = 0;
+    uint64_t checks = 0;
+    uint64_t discovered_checks = 0;
+    uint64_t double_checks = 0;
+    uint64_t checkmates = 0;
+
+    PerftStats& operator+=(const PerftStats& other);
+    bool operator==(const PerftStats& other) const = default;
+
+    // column titles matching the rows printed by operator<<
+    static void printHeader(std::ostream& os);
+
+    // one table row, prefixed by the depth
+    void printRow(std::ostream& os, int depth) const;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief   Perft suite runner: reads positions with their expected node counts from an EPD file
+ *          ("<fen> ;D1 20 ;D2 400 ..."), counts every (position, depth) pair on a thread pool
+ *          inside one process and reports the results as text or as JSON.
+ */
+namespace suite {
+    struct Case {
+        std::string fen;
+        int depth = 0;
+        uint64_t expected = 0;
+
+        uint64_t nodes = 0;
+        double ms = 0.0;
+        std::string error;      // set if the position could not be parsed
+
+        bool passed() const { return error.empty() && nodes == expected; }
+    };
+
+    struct Result {
+        std::vector<Case> cases;    // in the order of the file
+        int threads = 1;
+        double ms = 0.0;            // wall time of the whole suite
+
+        uint64_t nodes() const;
+        size_t passed() const;
+        uint64_t nps() const;
+    };
+
+    /**
+     * @brief   One case per ';D<depth> <nodes>' operation. Lines that are empty or start with '#' are skipped.
+     *          Throws std::runtime_error if the file can not be read or a line is malformed.
+     */
+    std::vector<Case> read(const std::string& path);
+
+    /**
+     * @brief   Counts all cases, every one with its own game and tables.
+     *          Bigger cases are started first, so the pool does not end waiting on a single slow one.
+     */
+    Result run(std::vector<Case> cases, int threads);
+
+    void print(const Result& result, std::ostream& os);
+    void writeJson(const Result& result, std::ostream& os);
+}; // namespace suite
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief   Fixed depth searches of the benchmark positions (bench::defaultPositions), every one
+ *          from a fresh game. Reports per depth the nodes of that iteration summed over all
+ *          positions, the time to reach the depth and the effective branching factor, the
+ *          ratio of the nodes of an iteration to the ones of the iteration before.
+ *          Comparing these before and after a search change shows what it does to the tree size.
+ */
+namespace search_bench {
+    struct Depth {
+        uint64_t nodes = 0;         // nodes of this iteration only
+        int64_t time = 0;           // milliseconds from the start of the search to the end of this iteration
+
+        // nodes of this iteration / nodes of the previous one, 0 for the first
+        double ebf = 0.0;
+    };
+
+    struct Result {
+        int depth = 0;
+        std::vector<Depth> depths;  // index 0 is depth 1
+    };
+
+    Result run(int depth, std::ostream& progress);
+
+    void print(const Result& result, std::ostream& os);
+
+    // searches of all positions to one depth with a number of threads
+    struct Scaling {
+        std::string mode;           // uci SplitMode
+        int threads = 0;
+        int64_t time = 0;           // milliseconds until the main thread finished the depth, summed over all positions
+        uint64_t nodes = 0;         // nodes of all threads until then
+    };
+
+    /**
+     * @brief   Thread scaling of the search: the benchmark positions are searched to depth with
+     *          1, 2, 4, ... threads up to max_threads, in every SplitMode. Time to depth shows what
+     *          the extra threads gain, nodes per second how well they run side by side and the
+     *          nodes compared to one thread how much work the threads repeat (search overhead).
+     */
+    std::vector<Scaling> scaling(int depth, int max_threads, std::ostream& progress);
+
+    void print(const std::vector<Scaling>& results, std::ostream& os);
+}; // namespace search_bench
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+#include "move.h"
+#include "search/score.h"
+
+/**
+ * @brief   Limits of one search, as given by the parameters of the uci 'go' command.
+ *          Times are in milliseconds, 0 means the limit is not set.
+ */
+struct SearchLimits {
+    int64_t wtime = 0;
+    int64_t btime = 0;
+    int64_t winc = 0;
+    int64_t binc = 0;
+    int movestogo = 0;
+    int64_t movetime = 0;
+    uint64_t nodes = 0;
+    int depth = 0;
+    bool infinite = false;
+    bool ponder = false;    // the clock only starts with ponderhit
+};
+
+// result of one finished iteration of the iterative deepening
+struct SearchInfo {
+    int depth = 0;
+    Score score = 0;        // from the view of the side to move, see search/score.h
+    uint64_t nodes = 0;
+    int64_t time = 0;       // milliseconds since the search started
+    Move best_move;
+};
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+
+#include "board/board.h"
+#include "eval.h"
+#include "move.h"
+
+// material the side to move wins with move, before any recapture
+inline Score materialGain(const Board& board, Move move)
+{
+    const PieceType victim = move.isEnpassant() ? PieceType::pawn : board.getPieceType(move.getTo());
+
+    Score gain = (victim == PieceType::none) ? 0 : pieceValue(victim);
+    if ( move.isPromotion() ) {
+        gain += pieceValue(move.getPromotionPieceType()) - pieceValue(PieceType::pawn);
+    }
+
+    return gain;
+}
+
+/**
+ * @brief   Most valuable victim, least valuable attacker: captures of the most valuable piece
+ *          come first, among those the one with the cheapest piece. A promotion counts as
+ *          capturing the piece it promotes to.
+ */
+inline int mvvLva(const Board& board, Move move)
+{
+    return materialGain(board, move) * 8 - utils::toByte(board.getPieceType(move.getFrom()));
+}
+
+/**
+ * @brief   Moves of a list with an ordering score each. Instead of sorting the whole list
+ *          up front, next() selects the best remaining move, so a cutoff after the first few
+ *          moves does not pay for sorting the rest.
+ */
+struct ScoredMoves {
+    MoveList& list;
+    std::array<int, 256> scores;
+    size_t index = 0;
+
+    explicit ScoredMoves(MoveList& list) : list(list) {}
+
+    // false once every move has been returned
+    bool next(Move& move)
+    {
+        if ( index >= list.size() ) {
+            return false;
+        }
+
+        size_t best = index;
+        for ( size_t i = index + 1; i < list.size(); ++i ) {
+            if ( scores[i] > scores[best] ) {
+                best = i;
+            }
+        }
+
+        std::swap(list[index], list[best]);
+        std::swap(scores[index], scores[best]);
+        move = list[index++];
+        return true;
+    }
+};
+
+/**
+ * @brief   What a search has learned about good moves, owned by one search thread.
+ *          Moves are tried in this order: the best move stored in the table, captures and
+ *          promotions by MVV-LVA, two killers of the ply (quiet moves that caused a cutoff in a
+ *          sibling node), the countermove of the previous move, and then all other quiet
+ *          moves by their butterfly history plus their continuation history, which rates a
+ *          move as the answer to the piece and target of the previous move.
+ */
+struct MoveOrdering {
+    // history entries stay within +-MAX_HISTORY, so they fit int16_t and below COUNTER
+    static constexpr int MAX_HISTORY = 16000;
+
+    static constexpr int TT_MOVE = 1 << 30;
+    static constexpr int CAPTURE = 1 << 29;
+    static constexpr int KILLER = 1 << 28;
+    static constexpr int COUNTER = 1 << 27;
+
+    std::array<std::array<Move, 2>, MAX_PLY + 1> killers {};
+    std::array<std::array<std::array<int16_t, 64>, 64>, 2> history {};            // [color][from][to]
+    std::array<std::array<std::array<Move, 64>, 64>, 2> countermoves {};           // [color][from][to] of the previous move
+    std::array<std::array<std::array<std::array<int16_t, 64>, 6>, 64>, 6> continuation {};  // [previous piece][previous to][piece][to]
+
+    // the current line, played[ply] is the move made at ply and played_piece[ply] the piece that made it
+    std::array<Move, MAX_PLY + 1> played {};
+    std::array<PieceType, MAX_PLY + 1> played_piece {};
+
+    // killers belong to the positions of one search, histories are only aged
+    void newSearch()
+    {
+        killers = {};
+        for ( auto& color : history ) {
+            for ( auto& from : color ) {
+                for ( auto& entry : from ) {
+                    entry /= 2;
+                }
+            }
+        }
+        for ( auto& previous : continuation ) {
+            for ( auto& previous_to : previous ) {
+                for ( auto& piece : previous_to ) {
+                    for ( auto& entry : piece ) {
+                        entry /= 2;
+                    }
+                }
+            }
+        }
+    }
+
+    // remembers move before searching the position after it
+    void play(int ply, Move move, PieceType piece)
+    {
+        played[ply] = move;
+        played_piece[ply] = piece;
+    }
+
+    template <Color color>
+    void score(ScoredMoves& moves, const Board& board, Move tt_move, int ply) const
+    {
+        const Move counter = (ply > 0) ? countermoves[utils::toByte(color)][played[ply - 1].getFrom()][played[ply - 1].getTo()] : Move();
+
+        for ( size_t i = 0; i < moves.list.size(); ++i ) {
+            const Move move = moves.list[i];
+            if ( move == tt_move ) {
+                moves.scores[i] = TT_MOVE;
+            }
+            else if ( move.isCapture() || move.isPromotion() ) {
+                moves.scores[i] = CAPTURE + mvvLva(board, move);
+            }
+            else if ( move == killers[ply][0] ) {
+                moves.scores[i] = KILLER;
+            }
+            else if ( move == killers[ply][1] ) {
+                moves.scores[i] = KILLER - 1;
+            }
+            else if ( move == counter ) {
+                moves.scores[i] = COUNTER;
+            }
+            else {
+                moves.scores[i] = history[utils::toByte(color)][move.getFrom()][move.getTo()]
+                    + continuationEntry(board, move, ply);
+            }
+        }
+    }
+
+    /**
+     * @brief   The quiet move best caused a beta cutoff at ply. It becomes a killer and the
+     *          countermove, its histories are raised and the ones of the quiet moves tried before
+     *          it (tried[0..count), without best) are lowered, more so the deeper the search.
+     */
+    template <Color color>
+    void updateQuiet(const Board& board, Move best, const Move* tried, size_t count, int depth, int ply)
+    {
+        if ( killers[ply][0] != best ) {
+            killers[ply][1] = killers[ply][0];
+            killers[ply][0] = best;
+        }
+
+        if ( ply > 0 ) {
+            countermoves[utils::toByte(color)][played[ply - 1].getFrom()][played[ply - 1].getTo()] = best;
+        }
+
+        const int bonus = std::min(depth * depth * 16, MAX_HISTORY / 4);
+        updateHistory<color>(board, best, bonus, ply);
+        for ( size_t i = 0; i < count; ++i ) {
+            updateHistory<color>(board, tried[i], -bonus, ply);
+        }
+    }
+
+private:
+    // moves the entry towards +-MAX_HISTORY, by less the closer it already is
+    static void gravity(int16_t& entry, int bonus)
+    {
+        entry += bonus - entry * std::abs(bonus) / MAX_HISTORY;
+    }
+
+    int continuationEntry(const Board& board, Move move, int ply) const
+    {
+        if ( ply == 0 || played[ply - 1] == Move() ) {
+            return 0;
+        }
+
+        return continuation[utils::toByte(played_piece[ply - 1])][played[ply - 1].getTo()]
+            [utils::toByte(board.getPieceType(move.getFrom()))][move.getTo()];
+    }
+
+    template <Color color>
+    void updateHistory(const Board& board, Move move, int bonus, int ply)
+    {
+        gravity(history[utils::toByte(color)][move.getFrom()][move.getTo()], bonus);
+
+        if ( ply > 0 && played[ply - 1] != Move() ) {
+            gravity(continuation[utils::toByte(played_piece[ply - 1])][played[ply - 1].getTo()]
+                [utils::toByte(board.getPieceType(move.getFrom()))][move.getTo()], bonus);
+        }
+    }
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+
+/**
+ * @brief   Tunable parameters of the selective search, all of them integers so they can be
+ *          set as uci spin options (see SEARCH_OPTIONS). Margins are in centipawns per ply of
+ *          remaining depth, the LMR constants in hundredths.
+ */
+struct SearchParams {
+    // null move pruning: the side to move passes, if the reduced search still fails high so does the node
+    int null_move_min_depth = 3;
+    int null_move_reduction = 3;        // plus one ply per 6 plies of depth
+    int null_move_verify_depth = 8;     // from here on a null move cutoff is verified by a reduced normal search
+
+    // late move reductions: reduction = base + ln(depth) * ln(move number) / divisor
+    int lmr_base = 75;
+    int lmr_divisor = 225;
+    int lmr_min_depth = 3;
+    int lmr_min_moves = 3;              // moves searched at full depth before reductions start
+
+    // reverse futility pruning: static eval - margin * depth >= beta is taken as a fail high
+    int rfp_max_depth = 6;
+    int rfp_margin = 80;
+
+    // futility pruning: quiet moves are skipped if static eval + margin * depth <= alpha
+    int futility_max_depth = 3;
+    int futility_margin = 100;
+};
+
+struct SearchOption {
+    const char* name;
+    int SearchParams::* value;
+    int min;
+    int max;
+};
+
+// uci options of the search parameters, announced on 'uci' and set with 'setoption name <name> value <n>'.
+// a min depth of 64 (or a max depth of 0) turns a technique off
+inline constexpr std::array<SearchOption, 11> SEARCH_OPTIONS = { {
+    { "NullMoveMinDepth", &SearchParams::null_move_min_depth, 1, 64 },
+    { "NullMoveReduction", &SearchParams::null_move_reduction, 1, 8 },
+    { "NullMoveVerifyDepth", &SearchParams::null_move_verify_depth, 1, 64 },
+    { "LmrBase", &SearchParams::lmr_base, 0, 300 },
+    { "LmrDivisor", &SearchParams::lmr_divisor, 50, 1000 },
+    { "LmrMinDepth", &SearchParams::lmr_min_depth, 1, 64 },
+    { "LmrMinMoves", &SearchParams::lmr_min_moves, 1, 64 },
+    { "RfpMaxDepth", &SearchParams::rfp_max_depth, 0, 16 },
+    { "RfpMargin", &SearchParams::rfp_margin, 0, 1000 },
+    { "FutilityMaxDepth", &SearchParams::futility_max_depth, 0, 16 },
+    { "FutilityMargin", &SearchParams::futility_margin, 0, 1000 },
+} };
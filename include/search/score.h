@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief   Scores are centipawns from the view of the side to move.
+ *          Being mated n plies from the root scores -(MATE - n), giving mate in n plies scores
+ *          MATE - n, so a shorter mate is always preferred over a longer one. Every other
+ *          score is within (-MATE_BOUND, MATE_BOUND). All of them fit into an int16_t.
+ */
+using Score = int32_t;
+
+static constexpr Score INFTY = 32000;
+static constexpr Score MATE = 31000;
+static constexpr int MAX_PLY = 128;
+static constexpr Score MATE_BOUND = MATE - MAX_PLY;
+
+constexpr bool isMateScore(Score score)
+{
+    return score >= MATE_BOUND || score <= -MATE_BOUND;
+}
+
+// score of the side to move that has been mated ply plies from the root
+constexpr Score matedIn(int ply)
+{
+    return -MATE + ply;
+}
+
+// moves (not plies) until the mate, negative if the side to move gets mated, as in the uci 'score mate'
+constexpr int mateInMoves(Score score)
+{
+    return (score > 0) ? (MATE - score + 1) / 2 : -(MATE + score) / 2;
+}
+
+/**
+ * @brief   The table is shared by all plies, so a mate score is stored relative to the
+ *          position of the entry instead of the root and converted back on the probe.
+ */
+constexpr int16_t scoreToTT(Score score, int ply)
+{
+    if ( score >= MATE_BOUND ) {
+        return static_cast<int16_t>(score + ply);
+    }
+    if ( score <= -MATE_BOUND ) {
+        return static_cast<int16_t>(score - ply);
+    }
+    return static_cast<int16_t>(score);
+}
+
+constexpr Score scoreFromTT(int16_t score, int ply)
+{
+    if ( score >= MATE_BOUND ) {
+        return score - ply;
+    }
+    if ( score <= -MATE_BOUND ) {
+        return score + ply;
+    }
+    return score;
+}
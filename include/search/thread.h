@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "board/board.h"
+#include "search/limits.h"
+#include "search/move_order.h"
+
+// how several threads share the search, the uci option SplitMode
+enum class SplitMode {
+    shared_tt,  // lazy SMP, every thread searches the whole tree and they share the eval table
+    ybwc        // young brothers wait concept, threads search the moves of split points together
+};
+
+// what every move of a node needs to be searched, see Game::searchMove
+struct SearchNode {
+    int depth = 0;
+    int ply = 0;
+    Score beta = 0;
+    bool pv_node = false;
+    bool in_check = false;
+    bool futile = false;        // quiet moves that do not give check are pruned
+    Score static_eval = 0;
+};
+
+struct SearchThread;
+
+/**
+ * @brief   Node whose remaining moves are searched by several threads. A node only splits
+ *          after its first move (the eldest brother) has been searched alone, so the bound
+ *          its young brothers are searched with is already a good one. Idle threads join a
+ *          split point and take one move at a time until none is left or one fails high.
+ *          Lives on the stack of the thread that split (the master), which waits until every
+ *          thread that joined has left.
+ */
+struct SplitPoint {
+    SplitPoint* parent = nullptr;   // split point the master was working for
+    Board board;                    // position of the node, the board of the master keeps moving
+    Color color = Color::white;     // to move at the node
+    SearchNode node;
+    ScoredMoves& moves;             // remaining moves, on the stack of the master
+    Move previous_move;             // move that led to the node, countermoves and continuation history are kept under it
+    PieceType previous_piece = PieceType::pawn;
+
+    std::mutex mutex;               // guards moves and the fields below
+    Score alpha = 0;
+    Score best_score = 0;
+    Move best_move;
+    int moves_searched = 0;
+    std::vector<SearchThread*> working;     // threads searching a move of this node, the master included
+    std::vector<SplitPoint*> children;      // split points made while searching a move of this node
+
+    std::atomic<bool> cutoff { false };
+    std::atomic<int> workers { 1 };     // the master and the threads that joined
+
+    SplitPoint(const Board& board, const SearchNode& node, ScoredMoves& moves) : board(board), node(node), moves(moves) {}
+
+    /**
+     * @brief   Marks this split point and the ones below it as failed high and stops every thread
+     *          working for them, so the search does not have to look for cutoffs above every node.
+     *          The mutex has to be held, the ones of the children are locked after it.
+     */
+    void cutOff();
+};
+
+/**
+ * @brief   State of one thread of the search. With several threads (lazy SMP) every thread
+ *          runs iterative deepening on its own copy of the root position and with its own move
+ *          ordering, they only share the eval table. Cutoffs one thread stores there change the
+ *          trees of the others, that is what makes them diverge. With SplitMode::ybwc only the
+ *          main thread runs iterative deepening, the others wait to join its split points.
+ */
+struct SearchThread {
+    int id = 0;                             // 0 is the main thread, the only one that checks the limits and reports
+    Board board;
+    MoveOrdering ordering;
+
+    std::atomic<uint64_t> nodes { 0 };      // only written by this thread, read by the main thread for limits and reports
+    std::atomic<bool> stopped { false };    // the current iteration was aborted, or a split point this thread works for failed high
+    SplitPoint* split_point = nullptr;      // innermost split point this thread works for
+    SearchInfo result;                      // last finished iteration, depth 0 if there is none
+
+    explicit SearchThread(int id) : id(id) {}
+
+    // returns the new node count
+    uint64_t countNode()
+    {
+        const uint64_t count = nodes.load(std::memory_order_relaxed) + 1;
+        nodes.store(count, std::memory_order_relaxed);
+        return count;
+    }
+};
+
+inline void SplitPoint::cutOff()
+{
+    cutoff = true;
+    for ( SearchThread* thread : working ) {
+        thread->stopped = true;
+    }
+
+    for ( SplitPoint* child : children ) {
+        std::lock_guard<std::mutex> lock(child->mutex);
+        child->cutOff();
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "search/limits.h"
+
+/**
+ * @brief   Decides how long a search may take.
+ *          The soft limit is checked between iterations: once it has passed no new iteration
+ *          is started. The hard limit is checked during an iteration and aborts it.
+ *          The soft limit is derived from the clock and scaled after every iteration by how
+ *          stable the best move is, so an unsure search thinks longer and a settled one
+ *          moves earlier. It never exceeds the hard limit.
+ */
+class TimeManager {
+public:
+    // starts the clock, white_to_move picks the side of the clock in limits
+    void start(const SearchLimits& limits, bool white_to_move);
+
+    // to be called after every finished iteration with its best move
+    void update(Move best_move);
+
+    bool softExpired() const { return timed && elapsed() >= soft; }
+    bool hardExpired() const { return timed && elapsed() >= hard; }
+
+    // milliseconds since start
+    int64_t elapsed() const;
+
+private:
+    // time lost between the gui and us per move
+    static constexpr int64_t MOVE_OVERHEAD = 20;
+    // moves the remaining time is split over if the gui does not send movestogo
+    static constexpr int DEFAULT_MOVES_TO_GO = 30;
+    // the hard limit takes at most this much of the remaining time
+    static constexpr double MAX_TIME_SHARE = 0.5;
+    // how far the hard limit may exceed the soft limit
+    static constexpr double HARD_FACTOR = 4.0;
+    // scale of the soft limit by the number of iterations the best move has not changed
+    static constexpr double STABILITY_SCALE[] = { 2.0, 1.4, 1.1, 0.9, 0.75 };
+    static constexpr int MAX_STABILITY = 4;
+
+    std::chrono::steady_clock::time_point begin;
+    bool timed = false;
+    bool scaled = false;     // movetime is used as given, only clock time is scaled
+    int64_t base_soft = 0;   // soft limit before the stability scaling
+    int64_t soft = 0;
+    int64_t hard = 0;
+
+    Move last_best_move;
+    int stability = 0;
+};
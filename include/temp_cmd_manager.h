@@ -2,6 +2,7 @@
 
 #include <string>
 #include <iostream>
+#include <mutex>
 
 #include "config.h"
 #include "board/board.h"
@@ -12,17 +13,25 @@
 
 class CommandManager {
 private:
+    // depth of a 'go' without any limits
+    static constexpr int DEFAULT_DEPTH = 5;
+
     std::string _fen = STARTPOS;
     Game game;
 
+    // the search thread prints info and bestmove while the input thread answers isready
+    std::mutex output_mutex;
+
     std::string& to_lower(std::string& s) { for ( char c : s ) { c = std::tolower(c); } return s; }
     Move makeMoveFromString(const std::string& moveStr, const Board& board);
 
+    // uci info line of a finished iteration
+    void printInfo(const SearchInfo& info);
+    // uci bestmove of a finished search
+    void printBestMove(const SearchInfo& result);
+
 public:
-    CommandManager()
-    {
-        game = Game();
-    }
+    CommandManager() = default;
 
     void parseCommand();
 };
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief   Fixed set of worker threads with one task queue each.
+ *          A worker takes its newest task from the back of its own queue, an idle worker
+ *          steals the oldest task from the front of another queue. Oldest tasks were split
+ *          off first and tend to be the largest, so a steal moves as much work as possible.
+ */
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(int threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief   Queues a task. Tasks are spread round robin over the workers,
+     *          stealing evens out whatever imbalance is left.
+     */
+    void submit(Task task);
+
+    /**
+     * @brief   Blocks until every submitted task has finished.
+     */
+    void wait();
+
+    int size() const { return static_cast<int>(workers.size()); }
+
+    // number of tasks a worker took from another queue since the pool was created
+    uint64_t steals() const { return steal_count.load(std::memory_order_relaxed); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;                       // guards the counters and stop for the condition variables
+    std::condition_variable work_available;
+    std::condition_variable all_done;
+    size_t pending = 0;                     // submitted but not finished
+    size_t queued = 0;                      // submitted but not taken by a worker yet
+    size_t next_queue = 0;
+    bool stop = false;
+
+    std::atomic<uint64_t> steal_count { 0 };
+
+    void run(size_t id);
+    bool pop(size_t id, Task& task);
+    bool steal(size_t id, Task& task);
+};
@@ -1,63 +1,423 @@
 #pragma once
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
+#include <string>
+#include <ostream>
+#include <utility>
 #include "move.h"
+#include "config.h"
+#include "zobrist.h"
 
-struct TTEntry_perft {
-    uint64_t key = 0;
-    uint64_t node_count = 0;
-    int depth_searched = 0;
+/**
+ * @brief   Perft bucket covering a whole cache line. The same position is reached at
+ *          different remaining depths through transpositions, with a single slot per index
+ *          those depths would keep overwriting each other. A bucket holds SLOTS (key, count)
+ *          pairs instead, so counts of several depths of one key (or of colliding keys)
+ *          live side by side and are read with a single cache miss.
+ *          The data word packs the depth into the top 8 bits and the node count into the rest.
+ *
+ *          Parallel perft shares one table between all threads without locks: a slot stores
+ *          key ^ data instead of the key, so a slot torn by two concurrent writers no longer
+ *          matches any key and reads as a miss instead of returning a wrong count.
+ */
+struct alignas(64) TTEntry_perft {
+    static constexpr int SLOTS = 4;
+    static constexpr int DEPTH_SHIFT = 56;
+    static constexpr uint64_t NODES_MASK = (1ULL << DEPTH_SHIFT) - 1;
+
+    struct Slot {
+        std::atomic<uint64_t> check { 0 };  // key ^ data
+        std::atomic<uint64_t> data { 0 };   // 0 = empty, depth 0 is never stored
+
+        inline uint64_t loadData() const { return data.load(std::memory_order_relaxed); }
+        inline uint64_t loadKey(uint64_t slot_data) const { return check.load(std::memory_order_relaxed) ^ slot_data; }
+    };
+
+    std::array<Slot, SLOTS> slots;
+
+    inline bool get(uint64_t key, int depth, uint64_t& nodes) const
+    {
+        const uint64_t wanted = static_cast<uint64_t>(depth) << DEPTH_SHIFT;
+        for ( const Slot& slot : slots ) {
+            const uint64_t data = slot.loadData();
+            if ( (data & ~NODES_MASK) == wanted && slot.loadKey(data) == key ) {
+                nodes = data & NODES_MASK;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief   Overwrites the slot holding the same key and depth, otherwise takes an
+     *          empty slot or replaces the shallowest one, as that subtree is the cheapest
+     *          to count again.
+     *
+     * @return int  depth of the overwritten slot, 0 if it was empty
+     */
+    inline int store(uint64_t key, int depth, uint64_t nodes)
+    {
+        if ( nodes > NODES_MASK ) {
+            return 0;
+        }
+
+        const uint64_t data = (static_cast<uint64_t>(depth) << DEPTH_SHIFT) | nodes;
+
+        int victim = 0;
+        int victim_depth = slotDepth(slots[0].loadData());
+        for ( int i = 0; i < SLOTS; ++i ) {
+            const uint64_t slot_data = slots[i].loadData();
+            if ( slot_data == 0ULL || (slotDepth(slot_data) == depth && slots[i].loadKey(slot_data) == key) ) {
+                victim = i;
+                victim_depth = slotDepth(slot_data);
+                break;
+            }
+
+            if ( slotDepth(slot_data) < victim_depth ) {
+                victim = i;
+                victim_depth = slotDepth(slot_data);
+            }
+        }
+
+        slots[victim].check.store(key ^ data, std::memory_order_relaxed);
+        slots[victim].data.store(data, std::memory_order_relaxed);
+        return victim_depth;
+    }
+
+    inline int used() const
+    {
+        int count = 0;
+        for ( const Slot& slot : slots ) {
+            count += slot.loadData() != 0ULL;
+        }
+        return count;
+    }
+
+    inline bool holds(uint64_t key) const
+    {
+        for ( const Slot& slot : slots ) {
+            const uint64_t data = slot.loadData();
+            if ( data != 0ULL && slot.loadKey(data) == key ) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    static constexpr int slotDepth(uint64_t data) { return static_cast<int>(data >> DEPTH_SHIFT); }
 };
 
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "perft slots rely on lock free 64 bit atomics");
+static_assert(sizeof(TTEntry_perft) == 64, "a perft entry has to fill exactly one cache line");
+
+/**
+ * @brief   Search entry. All search threads share one table without locks, like parallel
+ *          perft does: check stores the key xor the data word, so an entry torn by two
+ *          concurrent writers no longer holds any key and reads as a miss.
+ */
 struct TTEntry_eval {
-    uint64_t key = 0;
-    int depth_searched = 0;
-    double best_score = 0.0;
-    Move best_move = Move();
-    enum { EXACT, UPPERBOUND, LOWERBOUND } type;
+    static constexpr int SLOTS = 1;
+
+    enum Type : uint8_t { EXACT, UPPERBOUND, LOWERBOUND };
+
+    // what a probe returns, packed into the data word of the entry
+    struct Data {
+        int16_t depth_searched = 0;
+        int16_t best_score = 0;     // mate scores relative to this position, see scoreToTT
+        Move best_move = Move();
+        Type type = EXACT;
+
+        inline uint64_t pack() const
+        {
+            return static_cast<uint16_t>(depth_searched)
+                | (static_cast<uint64_t>(static_cast<uint16_t>(best_score)) << 16)
+                | (static_cast<uint64_t>(std::bit_cast<uint16_t>(best_move)) << 32)
+                | (static_cast<uint64_t>(type) << 48);
+        }
+
+        static inline Data unpack(uint64_t word)
+        {
+            return Data { static_cast<int16_t>(word), static_cast<int16_t>(word >> 16),
+                          std::bit_cast<Move>(static_cast<uint16_t>(word >> 32)), static_cast<Type>(word >> 48) };
+        }
+    };
+
+    std::atomic<uint64_t> check { 0 };     // key ^ data, 0 = empty
+    std::atomic<uint64_t> data { 0 };
+
+    /**
+     * @brief   Unpacks the entry into out if it holds key. Both words are loaded once,
+     *          the check is done on the loaded values as another thread may write meanwhile.
+     */
+    inline bool get(uint64_t key, Data& out) const
+    {
+        const uint64_t word = data.load(std::memory_order_relaxed);
+        const uint64_t entry_check = check.load(std::memory_order_relaxed);
+        if ( entry_check == 0ULL || (entry_check ^ word) != key ) {
+            return false;
+        }
+
+        out = Data::unpack(word);
+        return true;
+    }
+
+    inline void store(uint64_t key, int depth, int16_t score, Move move, Type type)
+    {
+        const uint64_t word = Data { static_cast<int16_t>(depth), score, move, type }.pack();
+        check.store(key ^ word, std::memory_order_relaxed);
+        data.store(word, std::memory_order_relaxed);
+    }
+
+    inline int depth() const { return Data::unpack(data.load(std::memory_order_relaxed)).depth_searched; }
+
+    inline int used() const { return check.load(std::memory_order_relaxed) != 0ULL; }
+};
+
+static_assert(sizeof(TTEntry_eval) == 16, "an eval entry should stay at 16 bytes, four per cache line");
+
+/**
+ * @brief   Usage counters of a table, only filled if ENABLE_TT_STATS is set.
+ *          A collision is a probe that found the index occupied by other keys only,
+ *          replacements are split by the depth of the new entry relative to the overwritten one.
+ */
+struct TTStats {
+    std::atomic<uint64_t> probes { 0 };
+    std::atomic<uint64_t> hits { 0 };
+    std::atomic<uint64_t> collisions { 0 };
+    std::atomic<uint64_t> stores { 0 };
+    std::atomic<uint64_t> replaced_shallower { 0 };    // new entry is deeper than the old one
+    std::atomic<uint64_t> replaced_equal { 0 };
+    std::atomic<uint64_t> replaced_deeper { 0 };       // new entry is shallower than the old one
+
+    inline void probe(bool hit, bool collision)
+    {
+        probes.fetch_add(1, std::memory_order_relaxed);
+        hits.fetch_add(hit, std::memory_order_relaxed);
+        collisions.fetch_add(collision, std::memory_order_relaxed);
+    }
+
+    inline void store(bool replaced, int old_depth, int new_depth)
+    {
+        stores.fetch_add(1, std::memory_order_relaxed);
+        if ( !replaced ) {
+            return;
+        }
+
+        if ( new_depth > old_depth ) replaced_shallower.fetch_add(1, std::memory_order_relaxed);
+        else if ( new_depth == old_depth ) replaced_equal.fetch_add(1, std::memory_order_relaxed);
+        else replaced_deeper.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void reset();
+
+    friend std::ostream& operator<<(std::ostream& os, const TTStats& stats);
+};
+
+/**
+ * @brief   Header in front of a table that was written to disk.
+ *          A file is only reused if every field matches the running binary,
+ *          otherwise the stored node counts could belong to different positions.
+ *          Padded to a cache line so the entries behind it stay aligned.
+ */
+struct alignas(64) TTFileHeader {
+    static constexpr uint64_t MAGIC = 0x5454554f4c53ULL;   // "SLOUTT"
+    static constexpr uint32_t VERSION = 4;                  // bump when an entry layout changes
+
+    uint64_t magic = MAGIC;
+    uint32_t version = VERSION;
+    uint32_t entry_size = 0;
+    uint64_t entry_count = 0;
+    uint64_t zobrist_seed = Zobrist::SEED;
+    uint64_t zobrist_fingerprint = Zobrist::fingerprint();
+
+    constexpr bool operator==(const TTFileHeader& other) const
+    {
+        return magic == other.magic && version == other.version
+            && entry_size == other.entry_size && entry_count == other.entry_count
+            && zobrist_seed == other.zobrist_seed && zobrist_fingerprint == other.zobrist_fingerprint;
+    }
+};
+
+namespace tt_file {
+    /**
+     * @brief   Maps a table file copy-on-write into memory. Returns nullptr if the file
+     *          does not exist or if its header does not match the expected one.
+     *
+     * @param path
+     * @param expected      header the file has to start with
+     * @param table_bytes   size of the table behind the header
+     * @return void*        start of the mapping, the table begins sizeof(TTFileHeader) bytes later
+     */
+    void* map(const std::string& path, const TTFileHeader& expected, size_t table_bytes);
+    void unmap(void* mapping, size_t table_bytes);
+
+    /**
+     * @brief   Writes header and table to path. The data is written to a temporary file
+     *          first and then renamed, so an interrupted dump never leaves a broken table behind.
+     *
+     * @return true on success
+     */
+    bool store(const std::string& path, const TTFileHeader& header, const void* table, size_t table_bytes);
 };
 
 template <typename Entry, size_t MB>
 class TTable {
     static constexpr size_t _size = (MB * 1000 * 1000) / sizeof(Entry);
     Entry* table;
+    void* mapping = nullptr;    // set if the table lives in a mapped file instead of the heap
+#if ENABLE_TT_STATS
+    mutable TTStats _stats;
+#endif
 public:
     TTable() : table(new Entry[_size]) { }
-    ~TTable() = default;
+    ~TTable() { release(); }
 
+    TTable(const TTable&) = delete;
+    TTable& operator=(const TTable&) = delete;
+
+    TTable(TTable&& other) noexcept
+        : table(std::exchange(other.table, nullptr)), mapping(std::exchange(other.mapping, nullptr))
+    { }
+
+    TTable& operator=(TTable&& other) noexcept
+    {
+        if ( this != &other ) {
+            release();
+            table = std::exchange(other.table, nullptr);
+            mapping = std::exchange(other.mapping, nullptr);
+#if ENABLE_TT_STATS
+            _stats.reset();
+#endif
+        }
+        return *this;
+    }
+
+    // for entries that always replace the slot, like TTEntry_eval
     template <typename... Args>
-    inline void emplace(uint64_t key, Args&&... args)
+    inline void emplace(uint64_t key, int depth, Args&&... args)
     {
-        const uint64_t index = getIdx(key);
-        table[index] = Entry { key, std::forward<Args>(args)... };
+        Entry& entry = table[getIdx(key)];
+#if ENABLE_TT_STATS
+        _stats.store(entry.used() != 0, entry.depth(), depth);
+#endif
+        entry.store(key, depth, std::forward<Args>(args)...);
     }
 
-    inline bool if_has_get(uint64_t key, int depth, uint64_t& nodes)
+    // for entries with their own lookup and replacement policy, like TTEntry_perft
+    inline bool if_has_get(uint64_t key, int depth, uint64_t& nodes) const
     {
-        const uint64_t index = getIdx(key);
-        const auto entry = table[index];
-        if ( entry.key == key && entry.depth_searched == depth ) {
-            nodes = entry.node_count;
-            return true;
-        }
-        else {
-            return false;
-        }
+        const Entry& entry = table[getIdx(key)];
+        const bool hit = entry.get(key, depth, nodes);
+#if ENABLE_TT_STATS
+        _stats.probe(hit, !hit && entry.used() != 0 && !entry.holds(key));
+#endif
+        return hit;
     }
 
-    inline bool has(uint64_t key, int depth) const
+    inline void store(uint64_t key, int depth, uint64_t nodes)
     {
-        const uint64_t index = getIdx(key);
-        const auto& entry = table[index];
-        return entry.key == key && entry.depth_searched == depth;
+        [[maybe_unused]] const int replaced_depth = table[getIdx(key)].store(key, depth, nodes);
+#if ENABLE_TT_STATS
+        _stats.store(replaced_depth != 0, replaced_depth, depth);
+#endif
     }
 
-    inline Entry get(uint64_t key)
+    /**
+     * @brief   Unpacks the slot of key into data, the caller decides whether its depth and
+     *          bound are enough.
+     *
+     * @return true if the slot holds key
+     */
+    template <typename Data>
+    inline bool probe(uint64_t key, Data& data) const
     {
-        uint64_t index = getIdx(key);
-        return table[index];
+        const Entry& entry = table[getIdx(key)];
+        const bool hit = entry.get(key, data);
+#if ENABLE_TT_STATS
+        _stats.probe(hit, !hit && entry.used() != 0);
+#endif
+        return hit;
     }
 
+    /**
+     * @brief   Starts loading the slot of key into the cache. Issue this as early as
+     *          the key is known, so the miss overlaps with other work before the probe.
+     */
+    inline void prefetch(uint64_t key) const { __builtin_prefetch(&table[getIdx(key)]); }
+
     constexpr size_t size() const { return _size; }
+
+    /**
+     * @brief   Estimated fill rate in permille (as in UCI 'info hashfull'),
+     *          sampled from the slots of the first entries.
+     */
+    int hashfull() const
+    {
+        constexpr size_t sample = std::min<size_t>(std::max(1000 / Entry::SLOTS, 1), _size);
+
+        int used = 0;
+        for ( size_t i = 0; i < sample; ++i ) {
+            used += table[i].used();
+        }
+
+        return static_cast<int>(used * 1000 / (sample * Entry::SLOTS));
+    }
+
+#if ENABLE_TT_STATS
+    const TTStats& stats() const { return _stats; }
+#endif
+
+    /**
+     * @brief   Replaces the table with the one stored in path, if the file was written
+     *          by a binary with the same entry layout and zobrist keys.
+     *
+     * @return true if the stored table is used from now on
+     */
+    bool load(const std::string& path)
+    {
+        void* file = tt_file::map(path, header(), bytes());
+        if ( file == nullptr ) {
+            return false;
+        }
+
+        release();
+        mapping = file;
+        table = reinterpret_cast<Entry*>(static_cast<char*>(file) + sizeof(TTFileHeader));
+        return true;
+    }
+
+    bool store(const std::string& path) const
+    {
+        return tt_file::store(path, header(), table, bytes());
+    }
+
 private:
     inline uint64_t getIdx(uint64_t key) const { return key % _size; }
+
+    static constexpr size_t bytes() { return _size * sizeof(Entry); }
+
+    static TTFileHeader header()
+    {
+        TTFileHeader header;
+        header.entry_size = sizeof(Entry);
+        header.entry_count = _size;
+        return header;
+    }
+
+    void release()
+    {
+        if ( mapping != nullptr ) {
+            tt_file::unmap(mapping, bytes());
+        }
+        else {
+            delete[] table;
+        }
+
+        table = nullptr;
+        mapping = nullptr;
+    }
 };
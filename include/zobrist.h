@@ -2,10 +2,10 @@
 
 #include <array>
 #include <cstdint>
-#include <unordered_map>
-#include <random>
 
 #include "definitions.h"
+#include "bitboard.h"
+#include "config.h"
 
 class Board; // fwd declaration
 
@@ -13,54 +13,107 @@ constexpr int kNumSquares = 64;
 constexpr int kNumPieces = 12;
 constexpr int kNumCastling = 4;
 namespace Zobrist {
-    extern std::array<std::array<uint64_t, kNumSquares>, kNumPieces> pieceKeys;
-    extern uint64_t blackToMove;
-    extern std::array<uint64_t, kNumCastling> castlingKeys;
-    extern std::array<uint64_t, kNumSquares> enPassantKeys;
-    extern std::unordered_map<uint64_t, uint64_t> table;
+    /**
+     * @brief   splitmix64, small enough to run at compiletime and fully specified,
+     *          so every platform and build generates the same keys for the same seed.
+     *
+     * @param state     advanced by every call
+     * @return uint64_t next random number
+     */
+    constexpr uint64_t splitmix64(uint64_t& state)
+    {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
 
-    inline char last_castling_rights;
+    struct Keys {
+        std::array<std::array<uint64_t, kNumSquares>, kNumPieces> pieces {};
+        uint64_t black_to_move = 0;
+        std::array<uint64_t, kNumCastling> castling {};
+        std::array<uint64_t, kNumSquares> en_passant {};
+    };
 
-    void initialize();
-    uint64_t computeHash(const Board& board);
+    constexpr Keys generateKeys(uint64_t seed)
+    {
+        Keys keys;
+        uint64_t state = seed;
 
-    inline void togglePiece(uint64_t& hash, int piece_id, int square) { hash ^= pieceKeys[piece_id][square]; }
+        for ( auto& pieceArray : keys.pieces ) {
+            for ( auto& key : pieceArray ) {
+                key = splitmix64(state);
+            }
+        }
 
-    template <Color color>
-    constexpr void toggleCastling(uint64_t& hash)
-    {
-        if constexpr ( utils::isWhite(color) ) {
-            hash ^= castlingKeys[0];
-            hash ^= castlingKeys[1];
+        keys.black_to_move = splitmix64(state);
+
+        for ( auto& key : keys.castling ) {
+            key = splitmix64(state);
         }
-        else {
-            hash ^= castlingKeys[2];
-            hash ^= castlingKeys[3];
+
+        for ( auto& key : keys.en_passant ) {
+            key = splitmix64(state);
         }
+
+        return keys;
     }
 
-    template <Color color>
-    constexpr void toggleCastlingQs(uint64_t& hash)
+    inline constexpr uint64_t SEED = ZOBRIST_SEED;
+    inline constexpr Keys keys = generateKeys(SEED);
+
+    inline constexpr const auto& pieceKeys = keys.pieces;
+    inline constexpr const auto& blackToMove = keys.black_to_move;
+    inline constexpr const auto& castlingKeys = keys.castling;
+    inline constexpr const auto& enPassantKeys = keys.en_passant;
+
+    constexpr uint64_t computeHash(const Board& board);   // defined in board.hpp, it needs the full Board
+
+    /**
+     * @brief   Folds all keys into a single number. Persisted data that depends on the keys
+     *          (like a stored perft table) is only valid if this value did not change.
+     */
+    constexpr uint64_t fingerprint()
     {
-        if constexpr ( utils::isWhite(color) ) {
-            hash ^= castlingKeys[1];
+        uint64_t result = 0xcbf29ce484222325ULL;
+        const auto fold = [&result](uint64_t key) { result = (result ^ key) * 0x100000001b3ULL; };
+
+        for ( const auto& pieceArray : pieceKeys ) {
+            for ( const auto key : pieceArray ) {
+                fold(key);
+            }
+        }
+
+        fold(blackToMove);
+
+        for ( const auto key : castlingKeys ) {
+            fold(key);
         }
-        else {
-            hash ^= castlingKeys[3];
+
+        for ( const auto key : enPassantKeys ) {
+            fold(key);
         }
+
+        return result;
     }
 
-    template <Color color>
-    constexpr void toggleCastlingKs(uint64_t& hash)
+    constexpr void togglePiece(uint64_t& hash, int piece_id, int square) { hash ^= pieceKeys[piece_id][square]; }
+
+    /**
+     * @brief   Toggles the keys of all castling rights set in 'changed'.
+     *          Bits follow the layout of State::castling_rights (see Board::CASTLE_WQ etc.).
+     *
+     * @param hash
+     * @param changed   old_rights ^ new_rights
+     */
+    constexpr void toggleCastlingRights(uint64_t& hash, char changed)
     {
-        if constexpr ( utils::isWhite(color) ) {
-            hash ^= castlingKeys[0];
-        }
-        else {
-            hash ^= castlingKeys[2];
-        }
+        if ( changed & 0b0010 ) hash ^= castlingKeys[0];  // white kingside
+        if ( changed & 0b0001 ) hash ^= castlingKeys[1];  // white queenside
+        if ( changed & 0b1000 ) hash ^= castlingKeys[2];  // black kingside
+        if ( changed & 0b0100 ) hash ^= castlingKeys[3];  // black queenside
     }
 
-    inline void toggleEnPassant(uint64_t& hash, uint64_t ep_field) { hash ^= enPassantKeys[get_LSB(ep_field)]; }
-    inline void toggleBlackToMove(uint64_t& hash) { hash ^= blackToMove; }
+    constexpr void toggleEnPassant(uint64_t& hash, uint64_t ep_field) { if ( ep_field != 0ULL ) hash ^= enPassantKeys[get_LSB(ep_field)]; }
+    constexpr void toggleBlackToMove(uint64_t& hash) { hash ^= blackToMove; }
 };
@@ -1,9 +1,34 @@
 #!/bin/bash
 
-SCRIPT_DIR="$(dirname "$0")"
+# perftree calls this as: ./perftree_entry.sh <depth> "<fen>" ["<moves>"]
+#
+# every call is forwarded to a 'slou -perftree-server' that is started on the first call
+# and keeps running in the background, so the perft table stays warm between the steps
+# of a bisection. the server is restarted when bin/slou was rebuilt, stop it with
+#   kill "$(cat "${TMPDIR:-/tmp}/slou-perftree-$(id -u)/pid")"
 
-DEPTH=$1
-shift
-REST=$@
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+ENGINE="$SCRIPT_DIR/bin/slou"
 
-"${SCRIPT_DIR}/bin/slou" -debug "$DEPTH" "$REST"
\ No newline at end of file
+RUNTIME_DIR="${TMPDIR:-/tmp}/slou-perftree-$(id -u)"
+REQUESTS="$RUNTIME_DIR/requests"
+RESPONSES="$RUNTIME_DIR/responses"
+PID_FILE="$RUNTIME_DIR/pid"
+
+server_running() {
+    [[ -f "$PID_FILE" ]] && [[ ! "$ENGINE" -nt "$PID_FILE" ]] && kill -0 "$(cat "$PID_FILE")" 2>/dev/null
+}
+
+if ! server_running; then
+    [[ -f "$PID_FILE" ]] && kill "$(cat "$PID_FILE")" 2>/dev/null
+
+    mkdir -p "$RUNTIME_DIR"
+    rm -f "$REQUESTS" "$RESPONSES"
+    mkfifo "$REQUESTS" "$RESPONSES"
+
+    nohup "$ENGINE" -perftree-server "$REQUESTS" "$RESPONSES" > "$RUNTIME_DIR/log" 2>&1 &
+    echo $! > "$PID_FILE"
+fi
+
+echo "$*" > "$REQUESTS"
+cat "$RESPONSES"
@@ -1,5 +1,3 @@
-bin/slou -speed 4 startpos
-bin/slou -speed 5 startpos
-bin/slou -speed 6 startpos
-
-#bin/slou -speed 5 "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - "
\ No newline at end of file
+# single threaded benchmark over a fixed set of positions, see 'bin/slou -bench' for the options.
+# compare two runs with: bin/slou -bench-compare base.json new.json
+bin/slou -bench "$@"
@@ -7,6 +7,7 @@ Board::Board(const std::string& fen)
     state = new State();
 
     state->ep_field = 0ULL;
+    state->mailbox.fill(Piece::none);   // the member initializer only sets the first square
 
     std::string board_fen = fen.substr(0, fen.find_first_of(' '));
     unsigned index = 0;
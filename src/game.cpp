@@ -1,6 +1,79 @@
 #include "game.h"
+#include <cmath>
+#include <numeric>
+#include <thread>
 
 Game::Game(const std::string& fen)
+{
+    setPosition(fen);
+    threads.push_back(std::make_unique<SearchThread>(0));
+    initReductions();
+}
+
+bool Game::setOption(const std::string& name, const std::string& value_string)
+{
+    if ( name == "SplitMode" ) {
+        if ( value_string == "SharedTT" ) {
+            split_mode = SplitMode::shared_tt;
+        }
+        else if ( value_string == "YBWC" ) {
+            split_mode = SplitMode::ybwc;
+        }
+        else {
+            return false;
+        }
+        return true;
+    }
+
+    int value = 0;
+    try {
+        value = std::stoi(value_string);
+    }
+    catch ( std::exception& e ) {
+        return false;
+    }
+
+    if ( name == "Threads" ) {
+        const size_t count = std::clamp(value, 1, MAX_THREADS);
+        while ( threads.size() > count ) {
+            threads.pop_back();
+        }
+        while ( threads.size() < count ) {
+            threads.push_back(std::make_unique<SearchThread>(static_cast<int>(threads.size())));
+        }
+        return true;
+    }
+
+    for ( const auto& option : SEARCH_OPTIONS ) {
+        if ( name != option.name ) {
+            continue;
+        }
+
+        params.*option.value = std::clamp(value, option.min, option.max);
+        initReductions();
+        return true;
+    }
+
+    return false;
+}
+
+void Game::initReductions()
+{
+    // base + ln(depth) * ln(moves) / divisor, both in hundredths of a ply
+    for ( size_t depth = 0; depth < reductions.size(); ++depth ) {
+        for ( size_t moves = 0; moves < reductions[depth].size(); ++moves ) {
+            if ( depth == 0 || moves == 0 ) {
+                reductions[depth][moves] = 0;
+                continue;
+            }
+
+            const double reduction = params.lmr_base / 100.0 + std::log(depth) * std::log(moves) * 100.0 / params.lmr_divisor;
+            reductions[depth][moves] = static_cast<int>(reduction);
+        }
+    }
+}
+
+void Game::setPosition(const std::string& fen)
 {
     if ( fen == "startpos" ) {
         board = Board();
@@ -15,42 +88,367 @@ Game::Game(const std::string& fen)
     }
 }
 
-void Game::make_move(const std::string& algebraic_move)
+bool Game::make_move(const std::string& algebraic_move)
 {
-    const Move move = moveFromSring(algebraic_move);
-
+    // look the move up among the legal ones, the string alone does not tell en passant from a quiet move
+    MoveList list;
     if ( board.whiteTurn() ) {
-        board.move<Color::white>(move);
+        generate_moves<Color::white>(list, board);
     }
     else {
-        board.move<Color::black>(move);
+        generate_moves<Color::black>(list, board);
+    }
+
+    for ( const auto& move : list ) {
+        if ( move.toLongAlgebraic() != algebraic_move ) {
+            continue;
+        }
+
+        if ( board.whiteTurn() ) {
+            board.move<Color::white>(move);
+        }
+        else {
+            board.move<Color::black>(move);
+        }
+        return true;
     }
+
+    std::cerr << "Illegal move: " << algebraic_move << std::endl;
+    return false;
 }
 
 void Game::unmake_move(const std::string& algebraic_move)
 {
     const Move move = moveFromSring(algebraic_move);
 
+    // the move was made by the side that is not to move anymore
     if ( board.whiteTurn() ) {
-        board.undo<Color::white>(move);
+        board.undo<Color::black>(move);
     }
     else {
-        board.undo<Color::black>(move);
+        board.undo<Color::white>(move);
     }
 }
 
 Move Game::bestMove(int depth)
 {
-    if ( board.whiteTurn() ) {
-        return getBestMove<Color::white>(board, depth);
+    SearchLimits limits;
+    limits.depth = depth;
+    return search(limits).best_move;
+}
+
+SearchInfo Game::search(const SearchLimits& limits, const std::function<void(const SearchInfo&)>& report)
+{
+    stopSearch();
+    stop_requested = false;
+    pondering = limits.ponder;
+    return runSearch(limits, report);
+}
+
+void Game::startSearch(const SearchLimits& limits, std::function<void(const SearchInfo&)> report, std::function<void(const SearchInfo&)> done)
+{
+    stopSearch();
+
+    // reset here and not on the search thread, a stop that comes right after the start must not get lost
+    stop_requested = false;
+    pondering = limits.ponder;
+    search_thread = std::thread([this, limits, report, done] { done(runSearch(limits, report)); });
+}
+
+void Game::stopSearch()
+{
+    stop_requested = true;
+    if ( search_thread.joinable() ) {
+        search_thread.join();
+    }
+}
+
+SearchInfo Game::runSearch(const SearchLimits& limits, const std::function<void(const SearchInfo&)>& report)
+{
+    search_limits = limits;
+    search_begin = std::chrono::steady_clock::now();
+    search_white = board.whiteTurn();
+    search_has_result = false;
+    clock_started = false;
+    helpers_stop = false;
+    search_aborted = false;
+    time_manager.start(SearchLimits { .infinite = true }, search_white);
+
+    for ( auto& thread : threads ) {
+        thread->board = board;
+        thread->ordering.newSearch();
+        thread->nodes = 0;
+        thread->stopped = false;
+        thread->split_point = nullptr;
+        thread->result = SearchInfo();
+    }
+    checkLimits(*threads[0]);
+
+    const int max_depth = (limits.depth > 0) ? std::min(limits.depth, MAX_SEARCH_DEPTH) : MAX_SEARCH_DEPTH;
+
+    std::vector<std::thread> helpers;
+    for ( size_t i = 1; i < threads.size(); ++i ) {
+        if ( split_mode == SplitMode::ybwc ) {
+            helpers.emplace_back([this, i] { idleLoop(*threads[i]); });
+        }
+        else {
+            helpers.emplace_back([this, i, max_depth] { iterate(*threads[i], max_depth, {}); });
+        }
+    }
+
+    iterate(*threads[0], max_depth, report);
+
+    // the gui expects no bestmove before stop or ponderhit, even if there is nothing left to search
+    while ( !stop_requested && (limits.infinite || pondering) ) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    helpers_stop = true;
+    for ( auto& helper : helpers ) {
+        helper.join();
+    }
+
+    return voteResult();
+}
+
+void Game::iterate(SearchThread& thread, int max_depth, const std::function<void(const SearchInfo&)>& report)
+{
+    const bool main_thread = thread.id == 0;
+
+    MoveList root_moves;
+    if ( search_white ) {
+        generate_moves<Color::white>(root_moves, thread.board);
+    }
+    else {
+        generate_moves<Color::black>(root_moves, thread.board);
+    }
+
+    for ( int depth = 1; depth <= max_depth && root_moves.size() != 0; ++depth ) {
+        if ( !main_thread ) {
+            const size_t helper = (thread.id - 1) % SKIP_SIZE.size();
+            if ( ((depth + SKIP_PHASE[helper]) / SKIP_SIZE[helper]) % 2 != 0 ) {
+                continue;
+            }
+        }
+
+        SearchInfo info;
+        info.depth = depth;
+
+        // aspiration window around the score of the previous iteration, widened until the score is inside
+        Score window = ASPIRATION_WINDOW;
+        Score alpha = -INFTY;
+        Score beta = INFTY;
+        if ( depth >= ASPIRATION_DEPTH && thread.result.depth != 0 && !isMateScore(thread.result.score) ) {
+            alpha = std::max(thread.result.score - window, -INFTY);
+            beta = std::min(thread.result.score + window, INFTY);
+        }
+
+        while ( true ) {
+            if ( search_white ) {
+                info.best_move = getBestMove<Color::white>(thread, depth, info.score, alpha, beta);
+            }
+            else {
+                info.best_move = getBestMove<Color::black>(thread, depth, info.score, alpha, beta);
+            }
+
+            if ( thread.stopped ) {
+                break;
+            }
+
+            window *= 2;
+            if ( info.score <= alpha ) {
+                alpha = std::max(info.score - window, -INFTY);
+            }
+            else if ( info.score >= beta ) {
+                beta = std::min(info.score + window, INFTY);
+            }
+            else {
+                break;
+            }
+        }
+
+        if ( thread.stopped ) {
+            break;
+        }
+
+        info.nodes = totalNodes();
+        info.time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - search_begin).count();
+        thread.result = info;
+
+        if ( !main_thread ) {
+            continue;
+        }
+
+        search_has_result = true;
+        if ( report ) {
+            report(info);
+        }
+
+        time_manager.update(info.best_move);
+        checkLimits(thread);
+        if ( thread.stopped || time_manager.softExpired() ) {
+            break;
+        }
+    }
+}
+
+void Game::idleLoop(SearchThread& thread)
+{
+    ++idle_threads;
+    while ( !helpers_stop ) {
+        SplitPoint* split_point = pickSplitPoint(nullptr);
+        if ( split_point == nullptr ) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        joinSplitPoint(thread, *split_point);
+    }
+    --idle_threads;
+}
+
+SplitPoint* Game::pickSplitPoint(const SplitPoint* ancestor)
+{
+    std::lock_guard<std::mutex> lock(split_mutex);
+
+    // the split point closest to the root has the most work left to share
+    SplitPoint* split_point = nullptr;
+    for ( SplitPoint* candidate : split_points ) {
+        if ( candidate->cutoff || (split_point != nullptr && candidate->node.depth <= split_point->node.depth) ) {
+            continue;
+        }
+
+        // the ancestor is alive as long as a split point below it is in the list, so is the chain up to it
+        bool below_ancestor = ancestor == nullptr;
+        for ( const SplitPoint* parent = candidate->parent; parent != nullptr && !below_ancestor; parent = parent->parent ) {
+            below_ancestor = parent == ancestor;
+        }
+
+        if ( below_ancestor ) {
+            split_point = candidate;
+        }
+    }
+
+    if ( split_point != nullptr ) {
+        ++split_point->workers;
+        --idle_threads;
+    }
+    return split_point;
+}
+
+void Game::joinSplitPoint(SearchThread& thread, SplitPoint& split_point)
+{
+    SplitPoint* const previous = thread.split_point;
+    thread.board = split_point.board;
+    thread.split_point = &split_point;
+    // this thread never played the line to the node, a fail high here updates the histories under its last move
+    if ( split_point.node.ply > 0 ) {
+        thread.ordering.play(split_point.node.ply - 1, split_point.previous_move, split_point.previous_piece);
+    }
+    {
+        // under the mutex a cutoff either happened before and is seen here, or it stops this thread
+        std::lock_guard<std::mutex> lock(split_point.mutex);
+        split_point.working.push_back(&thread);
+        thread.stopped = split_point.cutoff || search_aborted || helpers_stop;
+    }
+
+    if ( split_point.color == Color::white ) {
+        searchSplitPoint<Color::white>(thread, split_point);
     }
     else {
-        return getBestMove<Color::black>(board, depth);
+        searchSplitPoint<Color::black>(thread, split_point);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(split_point.mutex);
+        split_point.working.erase(std::find(split_point.working.begin(), split_point.working.end(), &thread));
+    }
+    thread.split_point = previous;
+
+    ++idle_threads;
+    // the master may return as soon as this is done, split_point must not be touched after it
+    --split_point.workers;
+}
+
+SearchInfo Game::voteResult() const
+{
+    Score worst = INFTY;
+    for ( const auto& thread : threads ) {
+        if ( thread->result.depth != 0 ) {
+            worst = std::min(worst, thread->result.score);
+        }
+    }
+
+    std::vector<std::pair<Move, int64_t>> votes;
+    for ( const auto& thread : threads ) {
+        const SearchInfo& result = thread->result;
+        if ( result.depth == 0 ) {
+            continue;
+        }
+
+        auto vote = std::find_if(votes.begin(), votes.end(), [&](const auto& entry) { return entry.first == result.best_move; });
+        if ( vote == votes.end() ) {
+            votes.emplace_back(result.best_move, 0);
+            vote = votes.end() - 1;
+        }
+        vote->second += static_cast<int64_t>(result.score - worst + 20) * result.depth;
     }
+
+    // on a tie the move found first wins, threads[0] comes first
+    SearchInfo result;
+    const auto winner = std::max_element(votes.begin(), votes.end(), [](const auto& a, const auto& b) { return a.second < b.second; });
+    for ( const auto& thread : threads ) {
+        if ( winner != votes.end() && thread->result.depth > result.depth && thread->result.best_move == winner->first ) {
+            result = thread->result;
+        }
+    }
+
+    result.nodes = totalNodes();
+    result.time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - search_begin).count();
+    return result;
+}
+
+uint64_t Game::totalNodes() const
+{
+    uint64_t nodes = 0;
+    for ( const auto& thread : threads ) {
+        nodes += thread->nodes.load(std::memory_order_relaxed);
+    }
+    return nodes;
 }
 
-uint64_t Game::perftSimpleEntry(int depth)
+void Game::checkLimits(SearchThread& thread)
 {
+    if ( thread.id != 0 ) {
+        // cutoffs of split points are pushed into stopped by SplitPoint::cutOff
+        if ( helpers_stop || search_aborted ) {
+            thread.stopped = true;
+        }
+        return;
+    }
+
+    if ( !clock_started && !pondering ) {
+        time_manager.start(search_limits, search_white);
+        clock_started = true;
+    }
+
+    if ( !search_has_result ) {
+        return;
+    }
+
+    if ( stop_requested || time_manager.hardExpired() || (search_limits.nodes != 0 && totalNodes() >= search_limits.nodes) ) {
+        thread.stopped = true;
+        search_aborted = true;
+    }
+}
+
+uint64_t Game::perftSimpleEntry(int depth, int threads)
+{
+    if ( threads > 1 && depth > 1 ) {
+        const auto divide = perftDivide(depth, threads);
+        return std::accumulate(divide.begin(), divide.end(), 0ULL, [](uint64_t sum, const auto& entry) { return sum + entry.second; });
+    }
+
     constexpr bool print_moves = false;
     if ( board.whiteTurn() ) {
         return perft<Color::white, print_moves>(board, depth);
@@ -60,8 +458,17 @@ uint64_t Game::perftSimpleEntry(int depth)
     }
 }
 
-uint64_t Game::perftDetailEntry(int depth)
+uint64_t Game::perftDetailEntry(int depth, int threads)
 {
+    if ( threads > 1 && depth > 1 ) {
+        uint64_t nodes = 0ULL;
+        for ( const auto& [move, move_nodes] : perftDivide(depth, threads) ) {
+            std::cout << move.toLongAlgebraic() << ' ' << move_nodes << '\n';
+            nodes += move_nodes;
+        }
+        return nodes;
+    }
+
     constexpr bool print_moves = true;
     if ( board.whiteTurn() ) {
         return debug_perft<Color::white, print_moves>(board, depth);
@@ -71,6 +478,125 @@ uint64_t Game::perftDetailEntry(int depth)
     }
 }
 
+std::vector<Game::PerftTask> Game::splitRoot(int depth, int threads, MoveList& root_moves)
+{
+    if ( board.whiteTurn() ) {
+        generate_moves<Color::white>(root_moves, board);
+    }
+    else {
+        generate_moves<Color::black>(root_moves, board);
+    }
+
+    std::vector<PerftTask> tasks;
+    for ( size_t i = 0; i < root_moves.size(); ++i ) {
+        tasks.push_back(PerftTask { board, depth - 1, i });
+        if ( board.whiteTurn() ) {
+            tasks.back().board.move<Color::white>(root_moves[i]);
+        }
+        else {
+            tasks.back().board.move<Color::black>(root_moves[i]);
+        }
+    }
+
+    // all tasks are on the same ply, stop splitting before they reach the leaves
+    const size_t wanted_tasks = static_cast<size_t>(threads) * PERFT_TASKS_PER_THREAD;
+    while ( !tasks.empty() && tasks.size() < wanted_tasks && tasks.front().depth > 1 ) {
+        tasks = splitPerft(tasks);
+    }
+
+    return tasks;
+}
+
+std::vector<Game::PerftTask> Game::splitPerft(std::vector<PerftTask>& tasks)
+{
+    std::vector<PerftTask> children;
+    for ( auto& task : tasks ) {
+        if ( task.board.whiteTurn() ) {
+            splitPerft<Color::white>(task, children);
+        }
+        else {
+            splitPerft<Color::black>(task, children);
+        }
+    }
+
+    return children;
+}
+
+uint64_t Game::perftBoard(Board& board, int depth)
+{
+    if ( board.whiteTurn() ) {
+        return perft<Color::white>(board, depth);
+    }
+    else {
+        return perft<Color::black>(board, depth);
+    }
+}
+
+std::vector<std::pair<Move, uint64_t>> Game::perftDivide(int depth, int threads)
+{
+    MoveList root_moves;
+    std::vector<uint64_t> nodes;
+
+    if ( threads > 1 && depth > 1 ) {
+        nodes = parallelPerft<uint64_t>(depth, threads, root_moves, [this](PerftTask& task) {
+            return task.board.whiteTurn() ? perft<Color::white>(task.board, task.depth) : perft<Color::black>(task.board, task.depth);
+        });
+    }
+    else if ( board.whiteTurn() ) {
+        nodes = divide<Color::white>(depth, root_moves);
+    }
+    else {
+        nodes = divide<Color::black>(depth, root_moves);
+    }
+
+    std::vector<std::pair<Move, uint64_t>> result;
+    for ( size_t i = 0; i < root_moves.size(); ++i ) {
+        result.emplace_back(root_moves[i], nodes[i]);
+    }
+
+    return result;
+}
+
+PerftStats Game::perftStatsEntry(int depth, int threads)
+{
+    PerftStats stats;
+    if ( threads > 1 && depth > 1 ) {
+        MoveList root_moves;
+        const std::vector<PerftStats> root_stats = parallelPerft<PerftStats>(depth, threads, root_moves, [this](PerftTask& task) {
+            PerftStats task_stats;
+            if ( task.board.whiteTurn() ) {
+                perftStats<Color::white>(task.board, task.depth, task_stats);
+            }
+            else {
+                perftStats<Color::black>(task.board, task.depth, task_stats);
+            }
+            return task_stats;
+        });
+
+        for ( const auto& move_stats : root_stats ) {
+            stats += move_stats;
+        }
+    }
+    else if ( board.whiteTurn() ) {
+        perftStats<Color::white>(board, depth, stats);
+    }
+    else {
+        perftStats<Color::black>(board, depth, stats);
+    }
+
+    return stats;
+}
+
+bool Game::loadPerftTable(const std::string& path)
+{
+    return tt_perft.load(path);
+}
+
+bool Game::storePerftTable(const std::string& path) const
+{
+    return tt_perft.store(path);
+}
+
 Move Game::moveFromSring(const std::string& algebraic_move)
 {
     if ( algebraic_move.length() < 4 ) {
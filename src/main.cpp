@@ -4,25 +4,76 @@
 #include <string>
 #include <sstream>
 #include <cctype>
+#include <charconv>
+#include <algorithm>
+#include <memory>
+#include <fstream>
+#include <thread>
 
 #include "temp_cmd_manager.h"
 #include "move_generator/move_generation.h"
 #include "game.h"
 #include "config.h"
 #include "eval.h"
+#include "perft/shards.h"
+#include "perft/suite.h"
+#include "perft/journal.h"
+#include "perft/bench.h"
+#include "search/bench.h"
 
 void perft_test(const std::vector<std::string>& args);
 void detailed_perft_test(const std::vector<std::string>& args);
 void speed_test(const std::vector<std::string>& args);
 void debug_perft(const std::vector<std::string>& args);
+void tt_bench(const std::vector<std::string>& args);
+void perft_split(const std::vector<std::string>& args);
+void perft_shard(const std::vector<std::string>& args);
+int perft_merge(const std::vector<std::string>& args);
+int perft_suite(const std::vector<std::string>& args);
+void perft_stats(const std::vector<std::string>& args);
+void perftree_server(const std::vector<std::string>& args);
+void perft_journal(const std::vector<std::string>& args);
+void run_bench(const std::vector<std::string>& args);
+void bench_compare(const std::vector<std::string>& args);
+void search_benchmark(const std::vector<std::string>& args);
+void smp_benchmark(const std::vector<std::string>& args);
 void uci_interface();
 
+std::string extract_option(std::vector<std::string>& args, const std::string& option);
+void load_perft_table(Game& game);
+void store_perft_table(const Game& game);
+void print_perft_table_usage(const Game& game);
+int hardware_threads();
+
+// "-ttfile <path>": the perft table is loaded from this file on startup and written back on exit
+static std::string perft_table_file = "";
+
+// "-threads <n>": number of threads the perft modes count with, 0 if not set
+static int perft_threads = 0;
+
 int main(int argc, char** argv)
 {
     std::vector<std::string> args(argv, argv + argc);
     initializePrecomputedStuff();
 
-    if ( argc > 1 ) {
+    perft_table_file = extract_option(args, "-ttfile");
+
+    const std::string threads = extract_option(args, "-threads");
+    if ( !threads.empty() ) {
+        try {
+            perft_threads = std::stoi(threads);
+        }
+        catch ( std::exception& e ) {
+            perft_threads = 0;
+        }
+
+        if ( perft_threads < 1 ) {
+            std::cout << "\'-threads\' must be a positive number!\n";
+            return 1;
+        }
+    }
+
+    if ( args.size() > 1 ) {
         if ( args[1] == "-debug" ) {
             debug_perft(args);
         }
@@ -35,12 +86,63 @@ int main(int argc, char** argv)
         else if ( args[1] == "-perftd" ) {
             detailed_perft_test(args);
         }
+        else if ( args[1] == "-ttbench" ) {
+            tt_bench(args);
+        }
+        else if ( args[1] == "-perft-split" ) {
+            perft_split(args);
+        }
+        else if ( args[1] == "-perft-shard" ) {
+            perft_shard(args);
+        }
+        else if ( args[1] == "-perft-merge" ) {
+            return perft_merge(args);
+        }
+        else if ( args[1] == "-perftsuite" ) {
+            return perft_suite(args);
+        }
+        else if ( args[1] == "-perftstats" ) {
+            perft_stats(args);
+        }
+        else if ( args[1] == "-perftree-server" ) {
+            perftree_server(args);
+        }
+        else if ( args[1] == "-perft-journal" ) {
+            perft_journal(args);
+        }
+        else if ( args[1] == "-bench" ) {
+            run_bench(args);
+        }
+        else if ( args[1] == "-bench-compare" ) {
+            bench_compare(args);
+        }
+        else if ( args[1] == "-searchbench" ) {
+            search_benchmark(args);
+        }
+        else if ( args[1] == "-smpbench" ) {
+            smp_benchmark(args);
+        }
         else {
             std::cout << "Usage:\n"
                 << "-test" << '\n'
                 << "-perft <depth> [\"fen\"|startpos] <expected>" << '\n'
                 << "-speed <depth> [\"fen\"|startpos]" << '\n'
-                << "-perftd <depth> [\"fen\"|startpos]"
+                << "-perftd <depth> [\"fen\"|startpos]" << '\n'
+                << "-ttbench" << '\n'
+                << "-perft-split <depth> [\"fen\"|startpos] <k> <manifest> [shards]" << '\n'
+                << "-perft-shard <manifest> <i>" << '\n'
+                << "-perft-merge <manifest>" << '\n'
+                << "-perftsuite <file.epd> [-json <path>]" << '\n'
+                << "-perftstats <depth> [\"fen\"|startpos]" << '\n'
+                << "-perftree-server [<request fifo> <response fifo>]" << '\n'
+                << "-perft-journal <depth> [\"fen\"|startpos] <journal> [unit ply]" << '\n'
+                << "-bench [-reps <n>] [-warmup <n>] [-cpu <k>] [-json <path>]" << '\n'
+                << "-bench-compare <base.json> <new.json> [alpha]" << '\n'
+                << "-searchbench [depth]" << '\n'
+                << "-smpbench [depth] [max threads]" << '\n'
+                << "options for perft modes:" << '\n'
+                << "  -ttfile <path>    reuse the perft table stored in <path> and update it on exit" << '\n'
+                << "  -threads <n>      count with n threads (all perft modes)"
                 << '\n';
         }
     }
@@ -70,6 +172,57 @@ void uci_interface()
     cmd_manager.parseCommand();
 }
 
+// removes "<option> <value>" from args and returns the value, or "" if the option is not set
+std::string extract_option(std::vector<std::string>& args, const std::string& option)
+{
+    for ( size_t i = 1; i + 1 < args.size(); ++i ) {
+        if ( args[i] == option ) {
+            const std::string value = args[i + 1];
+            args.erase(args.begin() + i, args.begin() + i + 2);
+            return value;
+        }
+    }
+
+    return "";
+}
+
+void load_perft_table(Game& game)
+{
+    if ( perft_table_file.empty() ) {
+        return;
+    }
+
+    if ( !game.loadPerftTable(perft_table_file) ) {
+        std::cerr << "no usable perft table in " << perft_table_file << ", starting with an empty one\n";
+    }
+}
+
+// hashfull, plus the usage counters if they are compiled in
+void print_perft_table_usage(const Game& game)
+{
+    std::cout << "tt: hashfull " << game.perftHashfull() << "/1000";
+#if ENABLE_TT_STATS
+    std::cout << ' ' << game.perftTableStats();
+#endif
+    std::cout << '\n';
+}
+
+int hardware_threads()
+{
+    return static_cast<int>(std::max(std::thread::hardware_concurrency(), 1U));
+}
+
+void store_perft_table(const Game& game)
+{
+    if ( perft_table_file.empty() ) {
+        return;
+    }
+
+    if ( !game.storePerftTable(perft_table_file) ) {
+        std::cerr << "failed to write the perft table to " << perft_table_file << '\n';
+    }
+}
+
 void detailed_perft_test(const std::vector<std::string>& args)
 {
     const static std::string usage = "-perftd <depth> [\"fen\"|startpos]";
@@ -89,7 +242,7 @@ void detailed_perft_test(const std::vector<std::string>& args)
     const std::string fen = args[3];
     Game game;
     try {
-        game = Game(fen);
+        game.setPosition(fen);
     }
     catch ( std::string& e ) {
         std::cout << e << '\n'
@@ -97,7 +250,10 @@ void detailed_perft_test(const std::vector<std::string>& args)
         return;
     }
 
-    uint64_t nodes = game.perftDetailEntry(depth);
+    load_perft_table(game);
+    uint64_t nodes = game.perftDetailEntry(depth, perft_threads);
+    store_perft_table(game);
+
     std::cout << "Nodes searched: " << nodes << '\n';
 }
 
@@ -124,7 +280,7 @@ void perft_test(const std::vector<std::string>& args)
 
     Game game;
     try {
-        game = Game(fen);
+        game.setPosition(fen);
     }
     catch ( std::string& e ) {
         std::cout << e << '\n'
@@ -132,7 +288,9 @@ void perft_test(const std::vector<std::string>& args)
         return;
     }
 
-    uint64_t perft_result = game.perftSimpleEntry(depth);
+    load_perft_table(game);
+    uint64_t perft_result = game.perftSimpleEntry(depth, perft_threads);
+    store_perft_table(game);
 
     if ( args.size() == 4 ) {
         std::cout << perft_result << '\n';
@@ -155,6 +313,11 @@ void perft_test(const std::vector<std::string>& args)
             std::cout << RED << "failed: " << RESET << perft_result << '\n';
         }
     }
+
+    // scripts parse the plain -perft output, so only print the table usage when it was asked for at build time
+    if ( ENABLE_TT_STATS ) {
+        print_perft_table_usage(game);
+    }
 }
 
 // -speed <depth> ["fen"|startpos]
@@ -180,7 +343,7 @@ void speed_test(const std::vector<std::string>& args)
 
     Game game;
     try {
-        game = Game(fen);
+        game.setPosition(fen);
     }
     catch ( std::string& e ) {
         std::cout << e << '\n'
@@ -188,14 +351,24 @@ void speed_test(const std::vector<std::string>& args)
         return;
     }
 
+    load_perft_table(game);
+
     auto begin = std::chrono::high_resolution_clock::now();
-    uint64_t perft_result = game.perftSimpleEntry(depth);
+    uint64_t perft_result = game.perftSimpleEntry(depth, perft_threads);
     auto end = std::chrono::high_resolution_clock::now();
 
-    const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
-    const auto nps = perft_result * 1000 / duration;
+    store_perft_table(game);
+
+    // a warm perft table can answer in well under a millisecond, so count in microseconds
+    const auto duration = std::max<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count(), 1);
+    const auto nps = static_cast<uint64_t>(perft_result * 1e6 / duration);
 
-    std::cout << perft_result << " nodes in " << duration << "ms (" << nps << "nps)\n";
+    std::cout << perft_result << " nodes in " << std::fixed << std::setprecision(3) << duration / 1000.0 << "ms (" << nps << "nps";
+    if ( perft_threads > 1 ) {
+        std::cout << ", " << perft_threads << " threads, " << nps / perft_threads << "nps per thread";
+    }
+    std::cout << ")\n";
+    print_perft_table_usage(game);
 }
 
 void debug_perft(const std::vector<std::string>& args)
@@ -223,7 +396,7 @@ void debug_perft(const std::vector<std::string>& args)
 
     Game game;
     try {
-        game = Game(fen);
+        game.setPosition(fen);
     }
     catch ( std::string& e ) {
         std::cout << e << '\n'
@@ -243,6 +416,596 @@ void debug_perft(const std::vector<std::string>& args)
         }
     }
 
+    load_perft_table(game);
     uint64_t nodes = game.perftDetailEntry(depth);
+    store_perft_table(game);
+
     std::cout << '\n' << nodes << '\n';
-}
\ No newline at end of file
+}
+
+// keys of the probes in -ttbench, spread over the whole table
+constexpr uint64_t TT_BENCH_SEED = 0x9e3779b97f4a7c15ULL;
+constexpr uint64_t tt_bench_key(uint64_t key) { return key * 6364136223846793005ULL + 1442695040888963407ULL; }
+
+// perft never stores depth 1, the probes look for a depth that tt_bench_fill stored
+constexpr int TT_BENCH_DEPTH = 2;
+
+// the probes cycle through this many keys, half as many as the table has slots so nearly all of them stay stored
+template <typename Table>
+int tt_bench_key_count(const Table& table, int iterations)
+{
+    return static_cast<int>(std::min<size_t>(iterations, table.size() * TTEntry_perft::SLOTS / 2));
+}
+
+/**
+ * @brief   Stores every key the probes will ask for, so they take the hit path that the
+ *          prefetch is meant to speed up. Keys that collide in a full bucket still miss.
+ */
+template <typename Table>
+void tt_bench_fill(Table& table, int iterations)
+{
+    uint64_t key = TT_BENCH_SEED;
+    for ( int i = 0; i < tt_bench_key_count(table, iterations); ++i ) {
+        key = tt_bench_key(key);
+        table.store(key, TT_BENCH_DEPTH, (key >> 32) & 7);
+    }
+}
+
+/**
+ * @brief   Models the probe at the top of a perft child: make the move, then probe.
+ *          The next move depends on the probe result, like the control flow in a real search,
+ *          so a miss can not simply be hidden behind the next iteration.
+ *
+ * @return double   ns per make/probe/undo step
+ */
+template <bool prefetch, typename Table>
+double tt_probe_latency(Table& table, Board& board, const MoveList& moves, int iterations)
+{
+    const int key_count = tt_bench_key_count(table, iterations);
+    uint64_t key = TT_BENCH_SEED;
+    uint64_t nodes = 0ULL;
+    size_t index = 0;
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    for ( int i = 0; i < iterations; ++i ) {
+        key = (i % key_count == 0) ? tt_bench_key(TT_BENCH_SEED) : tt_bench_key(key);
+        const Move move = moves[index];
+
+        if constexpr ( prefetch ) {
+            table.prefetch(key);
+        }
+
+        board.move<Color::white>(move);
+        const bool hit = table.if_has_get(key, TT_BENCH_DEPTH, nodes);
+        board.undo<Color::white>(move);
+
+        index = (index + 1 + (hit ? nodes : 0)) % moves.size();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - begin).count() / iterations;
+}
+
+template <size_t MB>
+void tt_bench_table(Board& board, const MoveList& moves, int iterations)
+{
+    auto table = std::make_unique<TTable<TTEntry_perft, MB>>();
+    tt_bench_fill(*table, iterations);
+
+    const double without = tt_probe_latency<false>(*table, board, moves, iterations);
+    const double with = tt_probe_latency<true>(*table, board, moves, iterations);
+
+    std::cout << std::left << std::setw(COL_SPACING) << (std::to_string(MB) + "MB")
+        << std::setw(COL_SPACING) << std::fixed << std::setprecision(1) << without
+        << std::setw(COL_SPACING) << with
+        << std::setprecision(0) << (without - with) << "ns\n";
+}
+
+// -ttbench
+void tt_bench(const std::vector<std::string>& args)
+{
+    const static std::string usage = "-ttbench";
+    if ( args.size() != 2 ) {
+        std::cout << "usage: " << usage << '\n';
+        return;
+    }
+
+    constexpr int iterations = 5'000'000;
+
+    Board board("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - ");
+    MoveList moves;
+    generate_moves<Color::white>(moves, board);
+
+    std::cout << std::left << std::setw(COL_SPACING) << "table"
+        << std::setw(COL_SPACING) << "no prefetch"
+        << std::setw(COL_SPACING) << "prefetch"
+        << "saved per probe\n"
+        << THIN_LINE << '\n';
+
+    tt_bench_table<TTABLE_SIZE_MB>(board, moves, iterations);
+    tt_bench_table<1024>(board, moves, iterations);
+}
+
+// -perft-split <depth> ["fen"|startpos] <k> <manifest> [shards]
+void perft_split(const std::vector<std::string>& args)
+{
+    const static std::string usage = "-perft-split <depth> [\"fen\"|startpos] <k> <manifest> [shards]";
+    if ( args.size() < 6 || args.size() > 7 ) {
+        std::cout << "usage: " << usage << '\n';
+        return;
+    }
+
+    int depth = 0;
+    int split_ply = 0;
+    size_t shard_count = 16;
+    try {
+        depth = std::stoi(args[2]);
+        split_ply = std::stoi(args[4]);
+        if ( args.size() == 7 ) {
+            shard_count = std::stoull(args[6]);
+        }
+    }
+    catch ( std::exception& e ) {
+        std::cout << "\'depth\', \'k\' and \'shards\' must be numbers!\n"
+            << "usage: " << usage << '\n';
+        return;
+    }
+
+    const std::string& manifest_path = args[5];
+    try {
+        const shards::Manifest manifest = shards::split(args[3], depth, split_ply, shard_count);
+        shards::write(manifest, manifest_path);
+
+        std::cout << manifest.positions.size() << " positions at ply " << split_ply
+            << " in " << shard_count << " shards written to " << manifest_path << '\n';
+    }
+    catch ( std::exception& e ) {
+        std::cout << e.what() << '\n'
+            << "usage: " << usage << '\n';
+    }
+}
+
+// -perft-shard <manifest> <i>
+void perft_shard(const std::vector<std::string>& args)
+{
+    const static std::string usage = "-perft-shard <manifest> <i>";
+    if ( args.size() != 4 ) {
+        std::cout << "usage: " << usage << '\n';
+        return;
+    }
+
+    size_t shard = 0;
+    try {
+        shard = std::stoull(args[3]);
+    }
+    catch ( std::exception& e ) {
+        std::cout << "\'i\' must be a number!\n"
+            << "usage: " << usage << '\n';
+        return;
+    }
+
+    const std::string& manifest_path = args[2];
+    Game game;
+    try {
+        const shards::Manifest manifest = shards::read(manifest_path);
+
+        load_perft_table(game);
+        const uint64_t counted = shards::count(manifest, manifest_path, shard, game, perft_threads);
+        store_perft_table(game);
+
+        std::cout << "shard " << shard << " done, counted " << counted << " positions, results in "
+            << shards::resultPath(manifest_path, shard) << '\n';
+    }
+    catch ( std::exception& e ) {
+        std::cout << e.what() << '\n'
+            << "usage: " << usage << '\n';
+    }
+    catch ( std::string& e ) {
+        std::cout << e << '\n'
+            << "usage: " << usage << '\n';
+    }
+}
+
+// -perft-merge <manifest>
+// exits with 1 if there is no complete total, scripts that run the shards rely on it
+int perft_merge(const std::vector<std::string>& args)
+{
+    const static std::string usage = "-perft-merge <manifest>";
+    if ( args.size() != 3 ) {
+        std::cout << "usage: " << usage << '\n';
+        return 1;
+    }
+
+    try {
+        const shards::Manifest manifest = shards::read(args[2]);
+        const std::vector<uint64_t> nodes = shards::merge(manifest, args[2]);
+
+        uint64_t total = 0ULL;
+        for ( size_t i = 0; i < nodes.size(); ++i ) {
+            std::cout << manifest.root_moves[i] << ' ' << nodes[i] << '\n';
+            total += nodes[i];
+        }
+
+        std::cout << "Nodes searched: " << total << '\n';
+    }
+    catch ( std::exception& e ) {
+        std::cout << e.what() << '\n'
+            << "usage: " << usage << '\n';
+        return 1;
+    }
+    return 0;
+}
+
+// -perftsuite <file.epd> [-json <path>]
+// exits with 1 if the suite can not be read or a case failed
+int perft_suite(const std::vector<std::string>& args)
+{
+    const static std::string usage = "-perftsuite <file.epd> [-json <path>]";
+    std::vector<std::string> suite_args = args;
+    const std::string json_path = extract_option(suite_args, "-json");
+    if ( suite_args.size() != 3 ) {
+        std::cout << "usage: " << usage << '\n';
+        return 1;
+    }
+
+    std::vector<suite::Case> cases;
+    try {
+        cases = suite::read(suite_args[2]);
+    }
+    catch ( std::exception& e ) {
+        std::cout << e.what() << '\n'
+            << "usage: " << usage << '\n';
+        return 1;
+    }
+
+    // positions are independent, so by default every core gets its own
+    const int threads = perft_threads > 0 ? perft_threads : hardware_threads();
+    const suite::Result result = suite::run(std::move(cases), threads);
+
+    suite::print(result, std::cout);
+
+    if ( !json_path.empty() ) {
+        std::ofstream json(json_path, std::ios::trunc);
+        suite::writeJson(result, json);
+        if ( !json ) {
+            std::cerr << "failed to write " << json_path << '\n';
+            return 1;
+        }
+    }
+
+    return result.passed() == result.cases.size() ? 0 : 1;
+}
+
+// -perftstats <depth> ["fen"|startpos]
+void perft_stats(const std::vector<std::string>& args)
+{
+    const static std::string usage = "-perftstats <depth> [\"fen\"|startpos]";
+    if ( args.size() != 4 ) {
+        std::cout << "usage: " << usage << '\n';
+        return;
+    }
+
+    int depth = 0;
+    try {
+        depth = std::stoi(args[2]);
+    }
+    catch ( std::exception& e ) {
+        std::cout << "\'depth\' must be a number!\n"
+            << "usage: " << usage << '\n';
+        return;
+    }
+
+    Game game;
+    try {
+        game.setPosition(args[3]);
+    }
+    catch ( std::string& e ) {
+        std::cout << e << '\n'
+            << "usage: " << usage << '\n';
+        return;
+    }
+
+    // one row per depth, like the published tables
+    PerftStats::printHeader(std::cout);
+    for ( int d = 1; d <= depth; ++d ) {
+        game.perftStatsEntry(d, perft_threads).printRow(std::cout, d);
+    }
+}
+
+/**
+ * @brief   Answers one perftree request "<depth> <fen> [moves...]" in the divide format
+ *          perftree expects: one "<move> <nodes>" line per legal move, an empty line and the total.
+ *          The fen can have 4 or 6 fields, the moves may be preceded by "moves".
+ */
+void answer_perftree_request(Game& game, const std::string& request, int threads, std::ostream& out)
+{
+    std::istringstream in(request);
+    std::vector<std::string> tokens;
+    std::string token;
+    while ( in >> token ) {
+        tokens.push_back(token);
+    }
+
+    const auto is_number = [](const std::string& str) {
+        return !str.empty() && std::all_of(str.begin(), str.end(), [](unsigned char c) { return std::isdigit(c); });
+    };
+
+    // the request comes from outside, anything that is not a depth has to end in an error line and not in an exception
+    int depth = 0;
+    const auto [end, error] = tokens.empty() ? std::from_chars_result { nullptr, std::errc::invalid_argument }
+        : std::from_chars(tokens[0].data(), tokens[0].data() + tokens[0].size(), depth);
+
+    if ( tokens.size() < 5 || error != std::errc() || end != tokens[0].data() + tokens[0].size() ) {
+        out << "error: expected \"<depth> <fen> [moves...]\"\n\n0\n";
+        return;
+    }
+
+    if ( depth < 0 ) {
+        out << "error: depth must not be negative\n\n0\n";
+        return;
+    }
+
+    size_t next = 5;
+    while ( next < tokens.size() && next < 7 && is_number(tokens[next]) ) {
+        ++next;
+    }
+
+    std::string fen = tokens[1];
+    for ( size_t i = 2; i < next; ++i ) {
+        fen += ' ' + tokens[i];
+    }
+
+    try {
+        game.setPosition(fen);
+    }
+    catch ( std::string& e ) {
+        out << "error: " << e << "\n\n0\n";
+        return;
+    }
+
+    for ( size_t i = (next < tokens.size() && tokens[next] == "moves") ? next + 1 : next; i < tokens.size(); ++i ) {
+        if ( !game.make_move(tokens[i]) ) {
+            out << "error: illegal move " << tokens[i] << "\n\n0\n";
+            return;
+        }
+    }
+
+    // depth 0 counts the position itself and has no moves to divide by
+    if ( depth == 0 ) {
+        out << "\n1\n";
+        return;
+    }
+
+    uint64_t total = 0ULL;
+    for ( const auto& [move, nodes] : game.perftDivide(depth, threads) ) {
+        out << move.toLongAlgebraic() << ' ' << nodes << '\n';
+        total += nodes;
+    }
+
+    out << '\n' << total << '\n';
+}
+
+// -perftree-server [<request fifo> <response fifo>]
+void perftree_server(const std::vector<std::string>& args)
+{
+    const static std::string usage = "-perftree-server [<request fifo> <response fifo>]";
+    if ( args.size() != 2 && args.size() != 4 ) {
+        std::cout << "usage: " << usage << '\n';
+        return;
+    }
+
+    // one game for all requests, so the perft table stays warm between the steps of a bisection
+    Game game;
+    load_perft_table(game);
+    const int threads = perft_threads > 0 ? perft_threads : hardware_threads();
+
+    if ( args.size() == 2 ) {
+        std::string request;
+        while ( std::getline(std::cin, request) && request != "quit" ) {
+            answer_perftree_request(game, request, threads, std::cout);
+            std::cout << std::flush;
+        }
+    }
+    else {
+        // every client writes one request and then closes the fifo, reopening waits for the next one.
+        // the response fifo is closed after each answer, that is the end of file the client reads up to
+        bool quit = false;
+        while ( !quit ) {
+            std::ifstream requests(args[2]);
+            if ( !requests ) {
+                std::cerr << "can not open " << args[2] << '\n';
+                break;
+            }
+
+            std::string request;
+            while ( !quit && std::getline(requests, request) ) {
+                quit = request == "quit";
+                if ( !quit ) {
+                    std::ofstream response(args[3]);
+                    answer_perftree_request(game, request, threads, response);
+                }
+            }
+        }
+    }
+
+    store_perft_table(game);
+}
+
+// -perft-journal <depth> ["fen"|startpos] <journal> [unit ply]
+void perft_journal(const std::vector<std::string>& args)
+{
+    const static std::string usage = "-perft-journal <depth> [\"fen\"|startpos] <journal> [unit ply]";
+    if ( args.size() < 5 || args.size() > 6 ) {
+        std::cout << "usage: " << usage << '\n';
+        return;
+    }
+
+    int depth = 0;
+    int unit_ply = 0;
+    try {
+        depth = std::stoi(args[2]);
+        unit_ply = (args.size() == 6) ? std::stoi(args[5]) : std::min(depth - 1, 2);
+    }
+    catch ( std::exception& e ) {
+        std::cout << "\'depth\' and \'unit ply\' must be numbers!\n"
+            << "usage: " << usage << '\n';
+        return;
+    }
+
+    Game game;
+    load_perft_table(game);
+
+    try {
+        const auto begin = std::chrono::steady_clock::now();
+        const auto divide = journal::run(game, args[3], depth, unit_ply, args[4], std::max(perft_threads, 1));
+        const auto end = std::chrono::steady_clock::now();
+
+        uint64_t total = 0ULL;
+        std::cout << '\n';
+        for ( const auto& [move, nodes] : divide ) {
+            std::cout << move << ' ' << nodes << '\n';
+            total += nodes;
+        }
+
+        std::cout << "Nodes searched: " << total
+            << " (" << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << "ms in this run)\n";
+    }
+    catch ( std::exception& e ) {
+        std::cout << e.what() << '\n'
+            << "usage: " << usage << '\n';
+    }
+
+    store_perft_table(game);
+}
+
+// -bench [-reps <n>] [-warmup <n>] [-cpu <k>] [-json <path>]
+void run_bench(const std::vector<std::string>& args)
+{
+    const static std::string usage = "-bench [-reps <n>] [-warmup <n>] [-cpu <k>] [-json <path>]";
+    std::vector<std::string> bench_args = args;
+    const std::string reps = extract_option(bench_args, "-reps");
+    const std::string warmup = extract_option(bench_args, "-warmup");
+    const std::string cpu = extract_option(bench_args, "-cpu");
+    const std::string json_path = extract_option(bench_args, "-json");
+    if ( bench_args.size() != 2 ) {
+        std::cout << "usage: " << usage << '\n';
+        return;
+    }
+
+    bench::Settings settings;
+    try {
+        settings.repetitions = reps.empty() ? settings.repetitions : std::stoi(reps);
+        settings.warmup = warmup.empty() ? settings.warmup : std::stoi(warmup);
+        settings.cpu = cpu.empty() ? settings.cpu : std::stoi(cpu);
+    }
+    catch ( std::exception& e ) {
+        settings.repetitions = 0;
+    }
+
+    if ( settings.repetitions < 1 || settings.warmup < 0 ) {
+        std::cout << "\'-reps\', \'-warmup\' and \'-cpu\' must be numbers, at least one repetition!\n"
+            << "usage: " << usage << '\n';
+        return;
+    }
+
+    if ( perft_threads > 1 ) {
+        std::cout << "the benchmark always runs on a single thread, ignoring \'-threads\'\n";
+    }
+
+    const bench::Result result = bench::run(settings, std::cout);
+    bench::print(result, std::cout);
+
+    if ( !json_path.empty() ) {
+        std::ofstream json(json_path, std::ios::trunc);
+        bench::writeJson(result, json);
+        if ( !json ) {
+            std::cerr << "failed to write " << json_path << '\n';
+        }
+    }
+}
+
+// -bench-compare <base.json> <new.json> [alpha]
+void bench_compare(const std::vector<std::string>& args)
+{
+    const static std::string usage = "-bench-compare <base.json> <new.json> [alpha]";
+    if ( args.size() < 4 || args.size() > 5 ) {
+        std::cout << "usage: " << usage << '\n';
+        return;
+    }
+
+    double alpha = 0.05;
+    try {
+        alpha = (args.size() == 5) ? std::stod(args[4]) : alpha;
+    }
+    catch ( std::exception& e ) {
+        alpha = 0.0;
+    }
+
+    if ( alpha <= 0.0 || alpha >= 1.0 ) {
+        std::cout << "\'alpha\' must be a number between 0 and 1!\n"
+            << "usage: " << usage << '\n';
+        return;
+    }
+
+    try {
+        bench::compare(bench::readJson(args[2]), bench::readJson(args[3]), alpha, std::cout);
+    }
+    catch ( std::exception& e ) {
+        std::cout << e.what() << '\n'
+            << "usage: " << usage << '\n';
+    }
+}
+
+// -searchbench [depth]
+void search_benchmark(const std::vector<std::string>& args)
+{
+    const static std::string usage = "-searchbench [depth]";
+    if ( args.size() > 3 ) {
+        std::cout << "usage: " << usage << '\n';
+        return;
+    }
+
+    int depth = 6;
+    try {
+        depth = (args.size() == 3) ? std::stoi(args[2]) : depth;
+    }
+    catch ( std::exception& e ) {
+        depth = 0;
+    }
+
+    if ( depth < 1 ) {
+        std::cout << "\'depth\' must be a positive number!\n"
+            << "usage: " << usage << '\n';
+        return;
+    }
+
+    search_bench::print(search_bench::run(depth, std::cout), std::cout);
+}
+
+// -smpbench [depth] [max threads]
+void smp_benchmark(const std::vector<std::string>& args)
+{
+    const static std::string usage = "-smpbench [depth] [max threads]";
+    if ( args.size() > 4 ) {
+        std::cout << "usage: " << usage << '\n';
+        return;
+    }
+
+    int depth = 8;
+    int max_threads = 64;
+    try {
+        depth = (args.size() >= 3) ? std::stoi(args[2]) : depth;
+        max_threads = (args.size() == 4) ? std::stoi(args[3]) : max_threads;
+    }
+    catch ( std::exception& e ) {
+        depth = 0;
+    }
+
+    if ( depth < 1 || max_threads < 1 || max_threads > Game::MAX_THREADS ) {
+        std::cout << "\'depth\' and \'max threads\' must be positive, at most " << Game::MAX_THREADS << " threads!\n"
+            << "usage: " << usage << '\n';
+        return;
+    }
+
+    search_bench::print(search_bench::scaling(depth, max_threads, std::cout), std::cout);
+}
@@ -0,0 +1,404 @@
+#include "perft/bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "build_info.h"
+#include "config.h"
+#include "game.h"
+
+namespace bench {
+    double Position::min() const
+    {
+        return nps.empty() ? 0.0 : *std::min_element(nps.begin(), nps.end());
+    }
+
+    double Position::median() const
+    {
+        if ( nps.empty() ) {
+            return 0.0;
+        }
+
+        std::vector<double> sorted = nps;
+        std::sort(sorted.begin(), sorted.end());
+        const size_t mid = sorted.size() / 2;
+        return (sorted.size() % 2 == 1) ? sorted[mid] : (sorted[mid - 1] + sorted[mid]) / 2.0;
+    }
+
+    double Position::mean() const
+    {
+        return nps.empty() ? 0.0 : std::accumulate(nps.begin(), nps.end(), 0.0) / nps.size();
+    }
+
+    double Position::stddev() const
+    {
+        if ( nps.size() < 2 ) {
+            return 0.0;
+        }
+
+        const double m = mean();
+        double sum = 0.0;
+        for ( const double x : nps ) {
+            sum += (x - m) * (x - m);
+        }
+        return std::sqrt(sum / (nps.size() - 1));
+    }
+
+    std::vector<Position> defaultPositions()
+    {
+        // the usual perft positions, depths chosen so every one takes roughly the same time
+        return {
+            { "startpos", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5, 0, {} },
+            { "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 0, {} },
+            { "position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 6, 0, {} },
+            { "position4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 5, 0, {} },
+            { "position5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 0, {} },
+            { "position6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 0, {} },
+        };
+    }
+
+    namespace {
+        // pins the calling thread to one cpu, returns the cpu or -1 if that is not possible
+        int pinToCpu(int cpu)
+        {
+#ifdef __linux__
+            if ( cpu < 0 ) {
+                cpu = sched_getcpu();
+            }
+
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            if ( cpu >= 0 && sched_setaffinity(0, sizeof(set), &set) == 0 ) {
+                return cpu;
+            }
+#endif
+            return -1;
+        }
+
+        // one perft with fresh tables, returns the nodes per second
+        double measure(Position& position)
+        {
+            auto game = std::make_unique<Game>(position.fen);
+
+            const auto begin = std::chrono::steady_clock::now();
+            position.nodes = game->perftSimpleEntry(position.depth);
+            const auto end = std::chrono::steady_clock::now();
+
+            const double seconds = std::chrono::duration<double>(end - begin).count();
+            return position.nodes / std::max(seconds, 1e-9);
+        }
+
+        // regularized incomplete beta function I_x(a, b), continued fraction as in numerical recipes
+        double incompleteBeta(double a, double b, double x)
+        {
+            if ( x <= 0.0 || x >= 1.0 ) {
+                return x <= 0.0 ? 0.0 : 1.0;
+            }
+
+            // the continued fraction converges fast only below this point, use the symmetry otherwise
+            if ( x > (a + 1.0) / (a + b + 2.0) ) {
+                return 1.0 - incompleteBeta(b, a, 1.0 - x);
+            }
+
+            constexpr double tiny = 1e-300;
+            const double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a * std::log(x) + b * std::log(1.0 - x)) / a;
+
+            double c = 1.0;
+            double d = 1.0 - (a + b) * x / (a + 1.0);
+            d = 1.0 / (std::abs(d) < tiny ? tiny : d);
+            double h = d;
+
+            for ( int m = 1; m <= 200; ++m ) {
+                for ( int step = 0; step < 2; ++step ) {
+                    const double numerator = (step == 0)
+                        ? m * (b - m) * x / ((a + 2.0 * m - 1.0) * (a + 2.0 * m))
+                        : -(a + m) * (a + b + m) * x / ((a + 2.0 * m) * (a + 2.0 * m + 1.0));
+
+                    d = 1.0 + numerator * d;
+                    d = 1.0 / (std::abs(d) < tiny ? tiny : d);
+                    c = 1.0 + numerator / c;
+                    c = std::abs(c) < tiny ? tiny : c;
+                    h *= c * d;
+                }
+
+                if ( std::abs(c * d - 1.0) < 1e-12 ) {
+                    break;
+                }
+            }
+
+            return front * h;
+        }
+
+        // two sided p-value of welch's t-test, 1 if there are not enough samples
+        double welchTest(const Position& a, const Position& b)
+        {
+            if ( a.nps.size() < 2 || b.nps.size() < 2 ) {
+                return 1.0;
+            }
+
+            const double va = a.stddev() * a.stddev() / a.nps.size();
+            const double vb = b.stddev() * b.stddev() / b.nps.size();
+            if ( va + vb == 0.0 ) {
+                return a.mean() == b.mean() ? 1.0 : 0.0;
+            }
+
+            const double t = (a.mean() - b.mean()) / std::sqrt(va + vb);
+            const double df = (va + vb) * (va + vb)
+                / (va * va / (a.nps.size() - 1) + vb * vb / (b.nps.size() - 1));
+
+            return incompleteBeta(df / 2.0, 0.5, df / (df + t * t));
+        }
+
+        // fens and names never contain characters that need escaping apart from these
+        std::string jsonString(const std::string& str)
+        {
+            std::string escaped = "\"";
+            for ( const char c : str ) {
+                if ( c == '"' || c == '\\' ) {
+                    escaped += '\\';
+                }
+                escaped += c;
+            }
+            return escaped + "\"";
+        }
+
+        // value of "key": "..." in line, or "" if the line does not have it
+        std::string jsonStringField(const std::string& line, const std::string& key)
+        {
+            const size_t pos = line.find('"' + key + "\": \"");
+            if ( pos == std::string::npos ) {
+                return "";
+            }
+
+            std::string value;
+            for ( size_t i = pos + key.size() + 5; i < line.size() && line[i] != '"'; ++i ) {
+                if ( line[i] == '\\' && i + 1 < line.size() ) {
+                    ++i;
+                }
+                value += line[i];
+            }
+            return value;
+        }
+
+        // text after "key": up to the next ',' or ']' or '}', or "" if the line does not have it
+        std::string jsonRawField(const std::string& line, const std::string& key, char end = ',')
+        {
+            const size_t pos = line.find('"' + key + "\": ");
+            if ( pos == std::string::npos ) {
+                return "";
+            }
+
+            const size_t begin = pos + key.size() + 4;
+            return line.substr(begin, line.find_first_of(std::string(1, end) + "}", begin) - begin);
+        }
+    }
+
+    Result run(const Settings& settings, std::ostream& progress)
+    {
+        Result result;
+        result.git_hash = SLOU_GIT_HASH;
+        result.build_flags = SLOU_BUILD_FLAGS;
+        result.settings = settings;
+        result.cpu = pinToCpu(settings.cpu);
+        result.positions = defaultPositions();
+
+        if ( result.cpu < 0 ) {
+            progress << "could not pin the benchmark to a cpu, expect more noise\n";
+        }
+
+        for ( auto& position : result.positions ) {
+            progress << position.name << " depth " << position.depth << ": " << std::flush;
+
+            for ( int i = 0; i < settings.warmup; ++i ) {
+                measure(position);
+                progress << 'w' << std::flush;
+            }
+
+            for ( int i = 0; i < settings.repetitions; ++i ) {
+                position.nps.push_back(measure(position));
+                progress << '.' << std::flush;
+            }
+
+            progress << '\n';
+        }
+
+        return result;
+    }
+
+    void print(const Result& result, std::ostream& os)
+    {
+        os << std::left
+            << std::setw(12) << "Git:" << result.git_hash << '\n'
+            << std::setw(12) << "Build:" << result.build_flags << '\n'
+            << std::setw(12) << "Cpu:" << (result.cpu >= 0 ? std::to_string(result.cpu) : "not pinned") << '\n'
+            << std::setw(12) << "Runs:" << result.settings.repetitions << " (+" << result.settings.warmup << " warmup)\n"
+            << THIN_LINE << '\n'
+            << std::setw(12) << "position"
+            << std::setw(7) << "depth"
+            << std::setw(12) << "nodes"
+            << std::setw(14) << "min nps"
+            << std::setw(14) << "median nps"
+            << "stddev\n"
+            << THIN_LINE << '\n';
+
+        for ( const auto& position : result.positions ) {
+            std::ostringstream stddev;
+            stddev << std::fixed << std::setprecision(2) << 100.0 * position.stddev() / std::max(position.mean(), 1.0) << '%';
+
+            os << std::setw(12) << position.name
+                << std::setw(7) << position.depth
+                << std::setw(12) << position.nodes
+                << std::setw(14) << static_cast<uint64_t>(position.min())
+                << std::setw(14) << static_cast<uint64_t>(position.median())
+                << stddev.str() << '\n';
+        }
+
+        os << THIN_LINE << '\n';
+    }
+
+    void writeJson(const Result& result, std::ostream& os)
+    {
+        os << std::fixed << std::setprecision(1)
+            << "{\n"
+            << "  \"git\": " << jsonString(result.git_hash) << ",\n"
+            << "  \"build_flags\": " << jsonString(result.build_flags) << ",\n"
+            << "  \"cpu\": " << result.cpu << ",\n"
+            << "  \"repetitions\": " << result.settings.repetitions << ",\n"
+            << "  \"warmup\": " << result.settings.warmup << ",\n"
+            << "  \"positions\": [\n";
+
+        for ( size_t i = 0; i < result.positions.size(); ++i ) {
+            const Position& position = result.positions[i];
+            os << "    { \"name\": " << jsonString(position.name)
+                << ", \"fen\": " << jsonString(position.fen)
+                << ", \"depth\": " << position.depth
+                << ", \"nodes\": " << position.nodes
+                << ", \"nps\": [";
+
+            for ( size_t j = 0; j < position.nps.size(); ++j ) {
+                os << (j > 0 ? ", " : "") << position.nps[j];
+            }
+
+            os << "], \"min\": " << position.min()
+                << ", \"median\": " << position.median()
+                << ", \"stddev\": " << position.stddev()
+                << " }" << (i + 1 < result.positions.size() ? "," : "") << '\n';
+        }
+
+        os << "  ]\n"
+            << "}\n";
+    }
+
+    Result readJson(const std::string& path)
+    {
+        std::ifstream file(path);
+        if ( !file ) {
+            throw std::runtime_error("can not open " + path);
+        }
+
+        // writeJson puts every position on a line of its own, that is all this has to understand
+        Result result;
+        std::string line;
+        while ( std::getline(file, line) ) {
+            if ( const std::string git = jsonStringField(line, "git"); !git.empty() ) {
+                result.git_hash = git;
+            }
+            else if ( const std::string flags = jsonStringField(line, "build_flags"); !flags.empty() ) {
+                result.build_flags = flags;
+            }
+            else if ( const std::string name = jsonStringField(line, "name"); !name.empty() ) {
+                Position position;
+                position.name = name;
+                position.fen = jsonStringField(line, "fen");
+
+                try {
+                    position.depth = std::stoi(jsonRawField(line, "depth"));
+                    position.nodes = std::stoull(jsonRawField(line, "nodes"));
+
+                    std::istringstream samples(jsonRawField(line, "nps", ']').substr(1));
+                    std::string sample;
+                    while ( std::getline(samples, sample, ',') ) {
+                        position.nps.push_back(std::stod(sample));
+                    }
+                }
+                catch ( std::logic_error& e ) {
+                    throw std::runtime_error(path + ": malformed position '" + name + "'");
+                }
+
+                result.positions.push_back(position);
+            }
+        }
+
+        if ( result.positions.empty() ) {
+            throw std::runtime_error(path + ": no positions");
+        }
+
+        return result;
+    }
+
+    void compare(const Result& base, const Result& candidate, double alpha, std::ostream& os)
+    {
+        os << std::left
+            << std::setw(12) << "Base:" << base.git_hash << '\n'
+            << std::setw(12) << "Candidate:" << candidate.git_hash << '\n'
+            << THIN_LINE << '\n'
+            << std::setw(12) << "position"
+            << std::setw(14) << "base nps"
+            << std::setw(14) << "new nps"
+            << std::setw(10) << "change"
+            << std::setw(10) << "p"
+            << "verdict\n"
+            << THIN_LINE << '\n';
+
+        for ( const auto& a : base.positions ) {
+            const auto b = std::find_if(candidate.positions.begin(), candidate.positions.end(), [&a](const Position& p) {
+                return p.name == a.name && p.depth == a.depth;
+            });
+
+            if ( b == candidate.positions.end() ) {
+                os << std::setw(12) << a.name << "missing in the candidate\n";
+                continue;
+            }
+
+            if ( a.nodes != b->nodes ) {
+                os << std::setw(12) << a.name << RED << "node counts differ: " << a.nodes << " vs " << b->nodes << RESET << '\n';
+                continue;
+            }
+
+            const double change = 100.0 * (b->median() - a.median()) / std::max(a.median(), 1.0);
+            const double p = welchTest(*b, a);
+
+            std::ostringstream change_str;
+            std::ostringstream p_str;
+            change_str << std::fixed << std::setprecision(2) << std::showpos << change << '%';
+            p_str << std::fixed << std::setprecision(4) << p;
+
+            os << std::setw(12) << a.name
+                << std::setw(14) << static_cast<uint64_t>(a.median())
+                << std::setw(14) << static_cast<uint64_t>(b->median())
+                << std::setw(10) << change_str.str()
+                << std::setw(10) << p_str.str();
+
+            if ( p >= alpha ) {
+                os << "no significant difference\n";
+            }
+            else {
+                os << (change > 0 ? GREEN : RED) << (change > 0 ? "faster" : "slower") << RESET << '\n';
+            }
+        }
+
+        os << THIN_LINE << '\n';
+    }
+}; // namespace bench
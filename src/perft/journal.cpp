@@ -0,0 +1,208 @@
+#include "perft/journal.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+#include "board/board.h"
+#include "move_generator/move_generation.h"
+#include "game.h"
+#include "thread_pool.h"
+
+namespace journal {
+    namespace {
+        struct Unit {
+            std::string root;   // root move
+            std::string path;   // root move, followed by the reply for units on the second ply
+            Board board;
+        };
+
+        template <Color color>
+        void expand(const Unit& unit, std::vector<Unit>& children)
+        {
+            Board board = unit.board;
+            MoveList list;
+            generate_moves<color>(list, board);
+
+            for ( const auto& move : list ) {
+                const std::string name = move.toLongAlgebraic();
+                children.push_back(Unit { unit.root.empty() ? name : unit.root, unit.path.empty() ? name : unit.path + ' ' + name, board });
+                children.back().board.move<color>(move);
+            }
+        }
+
+        std::vector<Unit> expand(const std::vector<Unit>& units)
+        {
+            std::vector<Unit> children;
+            for ( const auto& unit : units ) {
+                if ( unit.board.whiteTurn() ) {
+                    expand<Color::white>(unit, children);
+                }
+                else {
+                    expand<Color::black>(unit, children);
+                }
+            }
+
+            return children;
+        }
+
+        std::string header(const std::string& fen, int depth, int unit_ply)
+        {
+            return "slou-perft-journal " + std::to_string(VERSION) + ' ' + std::to_string(depth) + ' ' + std::to_string(unit_ply) + ' ' + fen;
+        }
+
+        /**
+         * @brief   Finished units of an earlier run. A line only counts once its newline was written,
+         *          an interrupted run can leave a torn last line behind.
+         */
+        std::map<std::string, uint64_t> readJournal(const std::string& path, const std::string& expected_header)
+        {
+            std::map<std::string, uint64_t> finished;
+            std::ifstream file(path);
+            if ( !file ) {
+                return finished;
+            }
+
+            std::string line;
+            if ( std::getline(file, line) && line != expected_header ) {
+                throw std::runtime_error(path + " belongs to another run: " + line);
+            }
+
+            while ( std::getline(file, line) && !file.eof() ) {
+                const size_t space = line.find_last_of(' ');
+                if ( space == std::string::npos ) {
+                    continue;
+                }
+
+                try {
+                    finished[line.substr(0, space)] = std::stoull(line.substr(space + 1));
+                }
+                catch ( std::logic_error& e ) {
+                    // not a unit line, skip it
+                }
+            }
+
+            return finished;
+        }
+
+        // rewrites the journal without a torn last line, same pattern as the perft table dump
+        void writeJournal(const std::string& path, const std::string& header, const std::map<std::string, uint64_t>& finished)
+        {
+            const std::string tmp_path = path + ".tmp";
+            {
+                std::ofstream file(tmp_path, std::ios::trunc);
+                file << header << '\n';
+                for ( const auto& [unit, nodes] : finished ) {
+                    file << unit << ' ' << nodes << '\n';
+                }
+
+                if ( !file.flush() ) {
+                    throw std::runtime_error("failed to write " + tmp_path);
+                }
+            }
+
+            if ( std::rename(tmp_path.c_str(), path.c_str()) != 0 ) {
+                throw std::runtime_error("failed to replace " + path);
+            }
+        }
+
+        std::string formatDuration(double seconds)
+        {
+            const auto total = static_cast<uint64_t>(seconds);
+            std::ostringstream out;
+            out << std::setfill('0');
+            if ( total >= 3600 ) {
+                out << total / 3600 << 'h' << std::setw(2);
+            }
+            if ( total >= 60 ) {
+                out << (total / 60) % 60 << 'm' << std::setw(2);
+            }
+            out << total % 60 << 's';
+            return out.str();
+        }
+    }
+
+    std::vector<std::pair<std::string, uint64_t>> run(Game& game, const std::string& fen, int depth, int unit_ply, const std::string& path, int threads)
+    {
+        if ( unit_ply < 1 || unit_ply > 2 || unit_ply >= depth ) {
+            throw std::runtime_error("units have to be on ply 1 or 2 and above the leaves");
+        }
+
+        std::vector<Unit> root_moves = expand({ Unit { "", "", (fen == "startpos") ? Board() : Board(fen) } });
+        std::vector<Unit> units = (unit_ply == 1) ? root_moves : expand(root_moves);
+
+        const std::string journal_header = header(fen, depth, unit_ply);
+        std::map<std::string, uint64_t> finished = readJournal(path, journal_header);
+        writeJournal(path, journal_header, finished);
+
+        std::ofstream file(path, std::ios::app);
+        std::mutex mutex;   // guards the journal, the counters and the output
+
+        // the node estimate for the remaining units is the average of all finished ones
+        size_t done = 0;
+        uint64_t done_nodes = 0;
+        for ( const auto& unit : units ) {
+            if ( const auto it = finished.find(unit.path); it != finished.end() ) {
+                ++done;
+                done_nodes += it->second;
+            }
+        }
+
+        std::cout << units.size() << " units, " << done << " already in " << path << '\n';
+
+        const auto begin = std::chrono::steady_clock::now();
+        uint64_t counted_nodes = 0;     // counted by this run, for the nps
+        {
+            ThreadPool pool(threads);
+            for ( auto& unit : units ) {
+                if ( finished.count(unit.path) != 0 ) {
+                    continue;
+                }
+
+                pool.submit([&, &unit = unit] {
+                    const uint64_t nodes = game.perftBoard(unit.board, depth - unit_ply);
+
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if ( !(file << unit.path << ' ' << nodes << '\n' << std::flush) ) {
+                        std::cerr << "failed to append to " << path << '\n';
+                    }
+
+                    finished[unit.path] = nodes;
+                    ++done;
+                    done_nodes += nodes;
+                    counted_nodes += nodes;
+
+                    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+                    const double nps = counted_nodes / std::max(seconds, 1e-3);
+                    const double remaining_nodes = static_cast<double>(done_nodes) / done * (units.size() - done);
+
+                    std::cout << '[' << done << '/' << units.size() << "] " << unit.path << ' ' << nodes
+                        << " | " << static_cast<uint64_t>(nps) << "nps"
+                        << " | eta " << formatDuration(remaining_nodes / nps) << '\n';
+                });
+            }
+            pool.wait();
+        }
+
+        std::vector<std::pair<std::string, uint64_t>> result;
+        for ( const auto& root : root_moves ) {
+            result.emplace_back(root.path, 0ULL);
+        }
+
+        for ( const auto& unit : units ) {
+            for ( auto& [root, nodes] : result ) {
+                if ( root == unit.root ) {
+                    nodes += finished.at(unit.path);
+                }
+            }
+        }
+
+        return result;
+    }
+}; // namespace journal
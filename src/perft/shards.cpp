@@ -0,0 +1,350 @@
+#include "perft/shards.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "board/board.h"
+#include "move_generator/move_generation.h"
+#include "game.h"
+
+namespace shards {
+    namespace {
+        // a position on the split ply, together with the paths leading to it
+        struct Node {
+            Board board;
+            std::map<size_t, uint64_t> roots;
+        };
+
+        // fen without the move clocks, they do not change the node count
+        std::string positionFen(const Board& board)
+        {
+            const std::string fen = board.getFen();
+
+            size_t end = 0;
+            for ( int field = 0; field < 4 && end != std::string::npos; ++field ) {
+                end = fen.find(' ', end + (field != 0));
+            }
+
+            return fen.substr(0, end);
+        }
+
+        template <Color color>
+        void expand(Node& node, std::vector<Node>& children)
+        {
+            MoveList list;
+            generate_moves<color>(list, node.board);
+
+            for ( const auto& move : list ) {
+                children.push_back(Node { node.board, node.roots });
+                children.back().board.move<color>(move);
+            }
+        }
+
+        // expands every node by one ply and merges the children that transpose into each other
+        std::vector<Node> expand(std::vector<Node>& nodes)
+        {
+            std::vector<Node> children;
+            for ( auto& node : nodes ) {
+                if ( node.board.whiteTurn() ) {
+                    expand<Color::white>(node, children);
+                }
+                else {
+                    expand<Color::black>(node, children);
+                }
+            }
+
+            std::vector<Node> unique;
+            std::unordered_map<uint64_t, size_t> index_of;
+            for ( auto& child : children ) {
+                const auto [it, inserted] = index_of.try_emplace(child.board.getZobristKey(), unique.size());
+                if ( inserted ) {
+                    unique.push_back(std::move(child));
+                    continue;
+                }
+
+                Node& existing = unique[it->second];
+                for ( const auto& [root, paths] : child.roots ) {
+                    existing.roots[root] += paths;
+                }
+            }
+
+            return unique;
+        }
+
+        // a line only counts once its newline was written, a job killed mid-write leaves a torn last line
+        std::map<size_t, uint64_t> readResults(const std::string& path)
+        {
+            std::map<size_t, uint64_t> results;
+            std::ifstream file(path);
+
+            std::string line;
+            while ( std::getline(file, line) && !file.eof() ) {
+                std::istringstream in(line);
+                size_t index = 0;
+                uint64_t nodes = 0;
+                if ( in >> index >> nodes ) {
+                    results[index] = nodes;
+                }
+            }
+
+            return results;
+        }
+
+        // same pattern as the perft table dump: write a temporary file, then rename it
+        void writeResults(const std::string& path, const std::map<size_t, uint64_t>& results)
+        {
+            const std::string tmp_path = path + ".tmp";
+            {
+                std::ofstream file(tmp_path, std::ios::trunc);
+                for ( const auto& [index, nodes] : results ) {
+                    file << index << ' ' << nodes << '\n';
+                }
+
+                if ( !file.flush() ) {
+                    throw std::runtime_error("failed to write " + tmp_path);
+                }
+            }
+
+            if ( std::rename(tmp_path.c_str(), path.c_str()) != 0 ) {
+                throw std::runtime_error("failed to replace " + path);
+            }
+        }
+
+        std::string expectWord(std::istream& in, const std::string& word)
+        {
+            std::string line;
+            std::string found;
+            if ( !std::getline(in, line) || !(std::istringstream(line) >> found) || found != word ) {
+                throw std::runtime_error("manifest: expected '" + word + "'");
+            }
+
+            return line.substr(word.size() + (line.size() > word.size()));
+        }
+    }
+
+    Manifest split(const std::string& fen, int depth, int split_ply, size_t shard_count)
+    {
+        if ( split_ply < 1 || split_ply >= depth ) {
+            throw std::runtime_error("the split ply has to be between 1 and depth - 1");
+        }
+
+        if ( shard_count == 0 ) {
+            throw std::runtime_error("at least one shard is needed");
+        }
+
+        Manifest manifest;
+        manifest.fen = fen;
+        manifest.depth = depth;
+        manifest.split_ply = split_ply;
+        manifest.shard_count = shard_count;
+
+        Board root = (fen == "startpos") ? Board() : Board(fen);
+
+        MoveList root_moves;
+        if ( root.whiteTurn() ) {
+            generate_moves<Color::white>(root_moves, root);
+        }
+        else {
+            generate_moves<Color::black>(root_moves, root);
+        }
+
+        std::vector<Node> nodes;
+        for ( size_t i = 0; i < root_moves.size(); ++i ) {
+            manifest.root_moves.push_back(root_moves[i].toLongAlgebraic());
+
+            nodes.push_back(Node { root, { { i, 1ULL } } });
+            if ( root.whiteTurn() ) {
+                nodes.back().board.move<Color::white>(root_moves[i]);
+            }
+            else {
+                nodes.back().board.move<Color::black>(root_moves[i]);
+            }
+        }
+
+        for ( int ply = 1; ply < split_ply; ++ply ) {
+            nodes = expand(nodes);
+        }
+
+        for ( size_t i = 0; i < nodes.size(); ++i ) {
+            Position position;
+            position.shard = i % shard_count;
+            position.key = nodes[i].board.getZobristKey();
+            position.roots = std::move(nodes[i].roots);
+            position.fen = positionFen(nodes[i].board);
+            manifest.positions.push_back(std::move(position));
+        }
+
+        return manifest;
+    }
+
+    /*
+        slou-perft-manifest <version>
+        fen <root fen>
+        depth <depth>
+        split <ply>
+        shards <count>
+        roots <move> <move> ...
+        positions <count>
+        <shard> <key> <root>:<paths>,<root>:<paths>,... <fen>
+        ...
+    */
+    void write(const Manifest& manifest, const std::string& path)
+    {
+        std::ofstream file(path, std::ios::trunc);
+
+        file << "slou-perft-manifest " << Manifest::VERSION << '\n'
+            << "fen " << manifest.fen << '\n'
+            << "depth " << manifest.depth << '\n'
+            << "split " << manifest.split_ply << '\n'
+            << "shards " << manifest.shard_count << '\n'
+            << "roots";
+
+        for ( const auto& move : manifest.root_moves ) {
+            file << ' ' << move;
+        }
+
+        file << '\n' << "positions " << manifest.positions.size() << '\n';
+
+        for ( const auto& position : manifest.positions ) {
+            file << position.shard << ' ' << std::hex << position.key << std::dec << ' ';
+
+            bool first = true;
+            for ( const auto& [root, paths] : position.roots ) {
+                file << (first ? "" : ",") << root << ':' << paths;
+                first = false;
+            }
+
+            file << ' ' << position.fen << '\n';
+        }
+
+        if ( !file.flush() ) {
+            throw std::runtime_error("failed to write " + path);
+        }
+    }
+
+    Manifest read(const std::string& path)
+    {
+        std::ifstream file(path);
+        if ( !file ) {
+            throw std::runtime_error("can not open " + path);
+        }
+
+        Manifest manifest;
+        try {
+            if ( std::stoi(expectWord(file, "slou-perft-manifest")) != Manifest::VERSION ) {
+                throw std::runtime_error("manifest: unsupported version");
+            }
+
+            manifest.fen = expectWord(file, "fen");
+            manifest.depth = std::stoi(expectWord(file, "depth"));
+            manifest.split_ply = std::stoi(expectWord(file, "split"));
+            manifest.shard_count = std::stoull(expectWord(file, "shards"));
+
+            std::istringstream roots(expectWord(file, "roots"));
+            std::string move;
+            while ( roots >> move ) {
+                manifest.root_moves.push_back(move);
+            }
+
+            const size_t position_count = std::stoull(expectWord(file, "positions"));
+
+            std::string line;
+            while ( manifest.positions.size() < position_count && std::getline(file, line) ) {
+                std::istringstream in(line);
+                Position position;
+                std::string paths;
+
+                in >> position.shard >> std::hex >> position.key >> std::dec >> paths;
+                std::getline(in >> std::ws, position.fen);
+
+                std::istringstream path_list(paths);
+                std::string entry;
+                while ( std::getline(path_list, entry, ',') ) {
+                    const size_t colon = entry.find(':');
+                    position.roots[std::stoull(entry.substr(0, colon))] = std::stoull(entry.substr(colon + 1));
+                }
+
+                if ( !in || position.fen.empty() || position.shard >= manifest.shard_count ) {
+                    throw std::runtime_error("manifest: broken position line '" + line + "'");
+                }
+
+                manifest.positions.push_back(std::move(position));
+            }
+
+            if ( manifest.positions.size() != position_count ) {
+                throw std::runtime_error("manifest: missing positions");
+            }
+        }
+        catch ( std::logic_error& e ) {     // stoi and friends
+            throw std::runtime_error("manifest: " + path + " is broken");
+        }
+
+        return manifest;
+    }
+
+    std::string resultPath(const std::string& manifest_path, size_t shard)
+    {
+        return manifest_path + "." + std::to_string(shard) + ".result";
+    }
+
+    uint64_t count(const Manifest& manifest, const std::string& manifest_path, size_t shard, Game& game, int threads)
+    {
+        if ( shard >= manifest.shard_count ) {
+            throw std::runtime_error("the manifest only has " + std::to_string(manifest.shard_count) + " shards");
+        }
+
+        const std::string path = resultPath(manifest_path, shard);
+        const std::map<size_t, uint64_t> results = readResults(path);
+
+        // drop a torn line of an earlier run, from then on every result is appended
+        writeResults(path, results);
+        std::ofstream file(path, std::ios::app);
+
+        uint64_t counted = 0;
+        for ( size_t i = 0; i < manifest.positions.size(); ++i ) {
+            const Position& position = manifest.positions[i];
+            if ( position.shard != shard || results.count(i) != 0 ) {
+                continue;
+            }
+
+            game.setPosition(position.fen);
+            const uint64_t nodes = game.perftSimpleEntry(manifest.remainingDepth(), threads);
+
+            if ( !(file << i << ' ' << nodes << '\n' << std::flush) ) {
+                throw std::runtime_error("failed to write " + path);
+            }
+            ++counted;
+        }
+
+        return counted;
+    }
+
+    std::vector<uint64_t> merge(const Manifest& manifest, const std::string& manifest_path)
+    {
+        std::vector<std::map<size_t, uint64_t>> results(manifest.shard_count);
+        for ( size_t shard = 0; shard < manifest.shard_count; ++shard ) {
+            results[shard] = readResults(resultPath(manifest_path, shard));
+        }
+
+        std::vector<uint64_t> nodes(manifest.root_moves.size(), 0ULL);
+        for ( size_t i = 0; i < manifest.positions.size(); ++i ) {
+            const Position& position = manifest.positions[i];
+            const auto& shard_results = results[position.shard];
+
+            const auto result = shard_results.find(i);
+            if ( result == shard_results.end() ) {
+                throw std::runtime_error("shard " + std::to_string(position.shard) + " is not finished yet");
+            }
+
+            for ( const auto& [root, paths] : position.roots ) {
+                nodes.at(root) += result->second * paths;
+            }
+        }
+
+        return nodes;
+    }
+}; // namespace shards
@@ -0,0 +1,37 @@
+#include "perft/stats.h"
+
+#include <iomanip>
+
+static constexpr int COLUMN = 14;
+
+PerftStats& PerftStats::operator+=(const PerftStats& other)
+{
+    nodes += other.nodes;
+    captures += other.captures;
+    en_passants += other.en_passants;
+    castles += other.castles;
+    promotions += other.promotions;
+    checks += other.checks;
+    discovered_checks += other.discovered_checks;
+    double_checks += other.double_checks;
+    checkmates += other.checkmates;
+    return *this;
+}
+
+void PerftStats::printHeader(std::ostream& os)
+{
+    os << std::left << std::setw(6) << "depth";
+    for ( const char* title : { "nodes", "captures", "e.p.", "castles", "promotions", "checks", "disc.checks", "dbl.checks", "checkmates" } ) {
+        os << std::setw(COLUMN) << title;
+    }
+    os << '\n';
+}
+
+void PerftStats::printRow(std::ostream& os, int depth) const
+{
+    os << std::left << std::setw(6) << depth;
+    for ( const uint64_t value : { nodes, captures, en_passants, castles, promotions, checks, discovered_checks, double_checks, checkmates } ) {
+        os << std::setw(COLUMN) << value;
+    }
+    os << '\n';
+}
@@ -0,0 +1,212 @@
+#include "perft/suite.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+#include "config.h"
+#include "game.h"
+#include "thread_pool.h"
+
+namespace suite {
+    uint64_t Result::nodes() const
+    {
+        return std::accumulate(cases.begin(), cases.end(), 0ULL, [](uint64_t sum, const Case& c) { return sum + c.nodes; });
+    }
+
+    size_t Result::passed() const
+    {
+        return std::count_if(cases.begin(), cases.end(), [](const Case& c) { return c.passed(); });
+    }
+
+    uint64_t Result::nps() const
+    {
+        return ms > 0.0 ? static_cast<uint64_t>(nodes() * 1000.0 / ms) : 0ULL;
+    }
+
+    std::vector<Case> read(const std::string& path)
+    {
+        std::ifstream file(path);
+        if ( !file ) {
+            throw std::runtime_error("can not open " + path);
+        }
+
+        std::vector<Case> cases;
+        std::string line;
+        for ( int line_number = 1; std::getline(file, line); ++line_number ) {
+            if ( line.empty() || line[0] == '#' ) {
+                continue;
+            }
+
+            std::istringstream operations(line);
+            std::string fen;
+            std::getline(operations, fen, ';');
+            fen.erase(fen.find_last_not_of(' ') + 1);
+
+            std::string operation;
+            bool has_depth = false;
+            while ( std::getline(operations, operation, ';') ) {
+                std::istringstream in(operation);
+                std::string opcode;
+                Case c;
+                c.fen = fen;
+
+                if ( !(in >> opcode) || opcode.size() < 2 || opcode[0] != 'D' ) {
+                    continue;   // other EPD operations are allowed, but not used here
+                }
+
+                try {
+                    c.depth = std::stoi(opcode.substr(1));
+                }
+                catch ( std::exception& e ) {
+                    c.depth = 0;
+                }
+
+                if ( c.depth < 1 || !(in >> c.expected) ) {
+                    throw std::runtime_error(path + ":" + std::to_string(line_number) + ": malformed operation '" + operation + "'");
+                }
+
+                cases.push_back(c);
+                has_depth = true;
+            }
+
+            if ( !has_depth ) {
+                throw std::runtime_error(path + ":" + std::to_string(line_number) + ": no ';D<depth> <nodes>' operation");
+            }
+        }
+
+        return cases;
+    }
+
+    Result run(std::vector<Case> cases, int threads)
+    {
+        Result result;
+        result.threads = std::max(threads, 1);
+        result.cases = std::move(cases);
+
+        std::vector<size_t> order(result.cases.size());
+        std::iota(order.begin(), order.end(), 0);
+
+        // workers take their newest task first, so the biggest cases have to be submitted last
+        std::sort(order.begin(), order.end(), [&result](size_t a, size_t b) {
+            return result.cases[a].expected < result.cases[b].expected;
+        });
+
+        const auto begin = std::chrono::steady_clock::now();
+        {
+            ThreadPool pool(result.threads);
+            for ( const size_t i : order ) {
+                pool.submit([&c = result.cases[i]] {
+                    const auto case_begin = std::chrono::steady_clock::now();
+                    try {
+                        auto game = std::make_unique<Game>(c.fen);
+                        c.nodes = game->perftSimpleEntry(c.depth);
+                    }
+                    catch ( std::string& e ) {
+                        c.error = e;
+                    }
+                    catch ( std::exception& e ) {
+                        c.error = e.what();
+                    }
+                    c.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - case_begin).count();
+                });
+            }
+            pool.wait();
+        }
+        result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+        return result;
+    }
+
+    void print(const Result& result, std::ostream& os)
+    {
+        os << std::left
+            << std::setw(8) << "result"
+            << std::setw(7) << "depth"
+            << std::setw(COL_SPACING) << "nodes"
+            << std::setw(COL_SPACING) << "expected"
+            << std::setw(12) << "time"
+            << "fen\n"
+            << THIN_LINE << '\n';
+
+        for ( const auto& c : result.cases ) {
+            std::ostringstream time;
+            time << std::fixed << std::setprecision(1) << c.ms << "ms";
+
+            os << (c.passed() ? GREEN : RED) << std::setw(8) << (c.passed() ? "passed" : "failed") << RESET
+                << std::setw(7) << c.depth
+                << std::setw(COL_SPACING) << c.nodes
+                << std::setw(COL_SPACING) << c.expected
+                << std::setw(12) << time.str()
+                << c.fen;
+
+            if ( !c.error.empty() ) {
+                os << " (" << c.error << ')';
+            }
+
+            os << '\n';
+        }
+
+        const size_t passed = result.passed();
+        os << THIN_LINE << '\n'
+            << std::setw(12) << "Passed:" << passed << '/' << result.cases.size() << '\n';
+        if ( passed != result.cases.size() ) {
+            os << std::setw(12) << "Failed:" << result.cases.size() - passed << '/' << result.cases.size() << '\n';
+        }
+
+        os << std::setw(12) << "Threads:" << result.threads << '\n'
+            << std::setw(12) << "Duration:" << static_cast<uint64_t>(result.ms) << "ms\n"
+            << std::setw(12) << "Nodes:" << result.nodes() << '\n'
+            << std::setw(12) << "NPS:" << result.nps() << '\n'
+            << THIN_LINE << '\n';
+    }
+
+    // fens and error messages never contain characters that need escaping apart from these
+    static std::string jsonString(const std::string& str)
+    {
+        std::string escaped = "\"";
+        for ( const char c : str ) {
+            if ( c == '"' || c == '\\' ) {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped + "\"";
+    }
+
+    void writeJson(const Result& result, std::ostream& os)
+    {
+        os << std::fixed << std::setprecision(3)
+            << "{\n"
+            << "  \"threads\": " << result.threads << ",\n"
+            << "  \"cases\": " << result.cases.size() << ",\n"
+            << "  \"passed\": " << result.passed() << ",\n"
+            << "  \"duration_ms\": " << result.ms << ",\n"
+            << "  \"nodes\": " << result.nodes() << ",\n"
+            << "  \"nps\": " << result.nps() << ",\n"
+            << "  \"results\": [\n";
+
+        for ( size_t i = 0; i < result.cases.size(); ++i ) {
+            const Case& c = result.cases[i];
+            os << "    { \"fen\": " << jsonString(c.fen)
+                << ", \"depth\": " << c.depth
+                << ", \"expected\": " << c.expected
+                << ", \"nodes\": " << c.nodes
+                << ", \"passed\": " << (c.passed() ? "true" : "false")
+                << ", \"ms\": " << c.ms;
+
+            if ( !c.error.empty() ) {
+                os << ", \"error\": " << jsonString(c.error);
+            }
+
+            os << " }" << (i + 1 < result.cases.size() ? "," : "") << '\n';
+        }
+
+        os << "  ]\n"
+            << "}\n";
+    }
+}; // namespace suite
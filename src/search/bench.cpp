@@ -0,0 +1,151 @@
+#include "search/bench.h"
+
+#include <cmath>
+#include <iomanip>
+#include <memory>
+
+#include "config.h"
+#include "game.h"
+#include "perft/bench.h"
+
+namespace search_bench {
+    Result run(int depth, std::ostream& progress)
+    {
+        Result result;
+        result.depth = depth;
+        result.depths.resize(depth);
+
+        for ( const auto& position : bench::defaultPositions() ) {
+            progress << position.name << ": " << std::flush;
+
+            // the game is too large for the stack with its tables and move ordering
+            auto game = std::make_unique<Game>(position.fen);
+
+            SearchLimits limits;
+            limits.depth = depth;
+
+            uint64_t previous_nodes = 0;
+            game->search(limits, [&](const SearchInfo& info) {
+                Depth& entry = result.depths[info.depth - 1];
+                entry.nodes += info.nodes - previous_nodes;
+                entry.time += info.time;
+                previous_nodes = info.nodes;
+                progress << '.' << std::flush;
+            });
+
+            progress << '\n';
+        }
+
+        for ( size_t i = 1; i < result.depths.size(); ++i ) {
+            const uint64_t previous = result.depths[i - 1].nodes;
+            result.depths[i].ebf = (previous != 0) ? static_cast<double>(result.depths[i].nodes) / previous : 0.0;
+        }
+
+        return result;
+    }
+
+    void print(const Result& result, std::ostream& os)
+    {
+        os << THIN_LINE << '\n'
+            << std::left
+            << std::setw(7) << "depth"
+            << std::setw(14) << "nodes"
+            << std::setw(12) << "time (ms)"
+            << "ebf\n"
+            << THIN_LINE << '\n';
+
+        for ( size_t i = 0; i < result.depths.size(); ++i ) {
+            const Depth& depth = result.depths[i];
+            os << std::setw(7) << i + 1
+                << std::setw(14) << depth.nodes
+                << std::setw(12) << depth.time
+                << std::fixed << std::setprecision(2) << depth.ebf << '\n';
+        }
+
+        // geometric mean of the ebf of every iteration after the first
+        if ( result.depths.size() > 1 && result.depths.front().nodes != 0 ) {
+            const double growth = static_cast<double>(result.depths.back().nodes) / result.depths.front().nodes;
+            os << THIN_LINE << '\n'
+                << "mean ebf: " << std::fixed << std::setprecision(2) << std::pow(growth, 1.0 / (result.depths.size() - 1)) << '\n';
+        }
+
+        os << THIN_LINE << '\n';
+    }
+
+    std::vector<Scaling> scaling(int depth, int max_threads, std::ostream& progress)
+    {
+        std::vector<int> thread_counts;
+        for ( int threads = 1; threads < max_threads; threads *= 2 ) {
+            thread_counts.push_back(threads);
+        }
+        thread_counts.push_back(max_threads);
+
+        std::vector<Scaling> results;
+        for ( const std::string mode : { "SharedTT", "YBWC" } ) {
+            for ( int threads : thread_counts ) {
+                progress << mode << ", " << threads << " threads: " << std::flush;
+
+                Scaling scaling;
+                scaling.mode = mode;
+                scaling.threads = threads;
+                for ( const auto& position : bench::defaultPositions() ) {
+                    auto game = std::make_unique<Game>(position.fen);
+                    game->setOption("Threads", std::to_string(threads));
+                    game->setOption("SplitMode", mode);
+
+                    SearchLimits limits;
+                    limits.depth = depth;
+
+                    game->search(limits, [&](const SearchInfo& info) {
+                        if ( info.depth == depth ) {
+                            scaling.time += info.time;
+                            scaling.nodes += info.nodes;
+                        }
+                    });
+                    progress << '.' << std::flush;
+                }
+
+                progress << '\n';
+                results.push_back(scaling);
+            }
+        }
+
+        return results;
+    }
+
+    void print(const std::vector<Scaling>& results, std::ostream& os)
+    {
+        os << THIN_LINE << '\n'
+            << std::left
+            << std::setw(10) << "mode"
+            << std::setw(9) << "threads"
+            << std::setw(12) << "time (ms)"
+            << std::setw(14) << "nodes"
+            << std::setw(10) << "knps"
+            << std::setw(10) << "speedup"
+            << std::setw(13) << "nps scaling"
+            << "overhead\n"
+            << THIN_LINE << '\n';
+
+        const auto nps = [](const Scaling& scaling) { return scaling.nodes / std::max<double>(scaling.time, 1.0); };
+
+        // every mode is compared to its own run with the fewest threads
+        const Scaling* base = nullptr;
+        for ( const Scaling& scaling : results ) {
+            if ( base == nullptr || base->mode != scaling.mode ) {
+                base = &scaling;
+            }
+
+            os << std::setw(10) << scaling.mode
+                << std::setw(9) << scaling.threads
+                << std::setw(12) << scaling.time
+                << std::setw(14) << scaling.nodes
+                << std::setw(10) << std::fixed << std::setprecision(0) << nps(scaling)
+                << std::setw(10) << std::setprecision(2) << static_cast<double>(base->time) / std::max<int64_t>(scaling.time, 1)
+                << std::setw(13) << nps(scaling) / std::max(nps(*base), 1.0)
+                << static_cast<double>(scaling.nodes) / std::max<uint64_t>(base->nodes, 1) << '\n';
+        }
+
+        os << THIN_LINE << '\n';
+    }
+}; // namespace search_bench
@@ -0,0 +1,50 @@
+#include "search/time_manager.h"
+
+#include <algorithm>
+
+void TimeManager::start(const SearchLimits& limits, bool white_to_move)
+{
+    begin = std::chrono::steady_clock::now();
+    last_best_move = Move();
+    stability = 0;
+
+    const int64_t time = white_to_move ? limits.wtime : limits.btime;
+    const int64_t inc = white_to_move ? limits.winc : limits.binc;
+
+    if ( limits.movetime > 0 ) {
+        timed = true;
+        scaled = false;
+        hard = std::max<int64_t>(1, limits.movetime - MOVE_OVERHEAD);
+        soft = base_soft = hard;
+    }
+    else if ( time > 0 && !limits.infinite ) {
+        const int64_t available = std::max<int64_t>(1, time - MOVE_OVERHEAD);
+        const int moves_to_go = (limits.movestogo > 0) ? limits.movestogo : DEFAULT_MOVES_TO_GO;
+
+        timed = true;
+        scaled = true;
+        base_soft = available / moves_to_go + inc * 3 / 4;
+        hard = std::min<int64_t>(base_soft * HARD_FACTOR, available * MAX_TIME_SHARE);
+        hard = std::max<int64_t>(1, hard);
+        soft = base_soft = std::min(base_soft, hard);
+    }
+    else {
+        timed = false;
+        scaled = false;
+    }
+}
+
+void TimeManager::update(Move best_move)
+{
+    stability = (best_move == last_best_move) ? std::min(stability + 1, MAX_STABILITY) : 0;
+    last_best_move = best_move;
+
+    if ( scaled ) {
+        soft = std::min<int64_t>(base_soft * STABILITY_SCALE[stability], hard);
+    }
+}
+
+int64_t TimeManager::elapsed() const
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count();
+}
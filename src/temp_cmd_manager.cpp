@@ -1,6 +1,8 @@
 #include "temp_cmd_manager.h"
 #include "game.h"
 
+#include <algorithm>
+
 template <Color color>
 u64 perft_entry(Board& board, int depth);
 
@@ -91,6 +93,32 @@ Move CommandManager::makeMoveFromString(const std::string& moveStr, const Board&
     return Move(from, to, flag);
 }
 
+void CommandManager::printInfo(const SearchInfo& info)
+{
+    std::lock_guard<std::mutex> lock(output_mutex);
+    std::cout << "info depth " << info.depth;
+    if ( isMateScore(info.score) ) {
+        std::cout << " score mate " << mateInMoves(info.score);
+    }
+    else {
+        std::cout << " score cp " << info.score;
+    }
+    std::cout << " nodes " << info.nodes
+        << " nps " << info.nodes * 1000 / std::max<int64_t>(info.time, 1)
+        << " time " << info.time
+        << " hashfull " << game.evalHashfull()
+        << " pv " << info.best_move.toLongAlgebraic() << std::endl;
+}
+
+void CommandManager::printBestMove(const SearchInfo& result)
+{
+    std::lock_guard<std::mutex> lock(output_mutex);
+#if ENABLE_TT_STATS
+    std::cout << "info string tt " << game.evalTableStats() << '\n';
+#endif
+    std::cout << "bestmove " << (result.best_move == Move() ? "0000" : result.best_move.toLongAlgebraic()) << std::endl;
+}
+
 void CommandManager::parseCommand()
 {
     bool quit = false;
@@ -103,21 +131,48 @@ void CommandManager::parseCommand()
         std::string token;
         ss >> token;
         if ( to_lower(token) == "quit" ) {
+            game.stopSearch();
             quit = true;
         }
         else if ( token == "uci" ) {
+            std::lock_guard<std::mutex> lock(output_mutex);
             std::cout << "id name slou 1.1\n"
-                << "id author amazzetta\n\n"
-                << "uciok\n";
+                << "id author amazzetta\n\n";
+
+            std::cout << "option name Threads type spin default 1 min 1 max " << Game::MAX_THREADS << '\n';
+            std::cout << "option name SplitMode type combo default SharedTT var SharedTT var YBWC\n";
+
+            const SearchParams defaults;
+            for ( const auto& option : SEARCH_OPTIONS ) {
+                std::cout << "option name " << option.name << " type spin default " << defaults.*option.value
+                    << " min " << option.min << " max " << option.max << '\n';
+            }
+            std::cout << "uciok" << std::endl;
+        }
+        else if ( token == "setoption" ) {
+            // setoption name <name> value <n>
+            std::string name;
+            std::string value;
+            ss >> token >> name >> token >> value;
+
+            game.stopSearch();
+            if ( !game.setOption(name, value) ) {
+                std::cout << "info string unknown option " << name << '\n';
+            }
         }
         else if ( token == "stop" ) {
-            //quit = true;
+            game.stopSearch();
+        }
+        else if ( token == "ponderhit" ) {
+            game.ponderhit();
         }
         else if ( token == "position" ) {
+            // the search runs on the board of the game
+            game.stopSearch();
             ss >> token;
             if ( token == "startpos" ) {
                 _fen = STARTPOS;
-                game = Game(STARTPOS);
+                game.setPosition(STARTPOS);
                 ss >> token;
             }
             else if ( token == "fen" ) {
@@ -126,10 +181,11 @@ void CommandManager::parseCommand()
                     fen += token + " ";
                 }
 
-                game = Game(fen);
+                game.setPosition(fen);
             }
             else {
-                std::cout << "unknown command: " << token << '\n';
+                std::lock_guard<std::mutex> lock(output_mutex);
+                std::cout << "unknown command: " << token << std::endl;
             }
 
             if ( token == "moves" ) {
@@ -139,34 +195,58 @@ void CommandManager::parseCommand()
             }
         }
         else if ( token == "go" ) {
-            if ( ss >> token ) {
+            SearchLimits limits;
+            bool perft = false;
+            while ( ss >> token ) {
                 if ( token == "perft" ) {
-                    ss >> token;
-                    int depth = std::stoi(token);
-                    const uint64_t total_nodes = game.perftDetailEntry(depth);
-                    std::cout << '\n' << "nodes searched: " << total_nodes << '\n';
-                }
-                else {
-                    goto here; // uuuuuh goto ooooh nooo
+                    perft = true;
+                    ss >> limits.depth;
                 }
+                else if ( token == "wtime" ) { ss >> limits.wtime; }
+                else if ( token == "btime" ) { ss >> limits.btime; }
+                else if ( token == "winc" ) { ss >> limits.winc; }
+                else if ( token == "binc" ) { ss >> limits.binc; }
+                else if ( token == "movestogo" ) { ss >> limits.movestogo; }
+                else if ( token == "movetime" ) { ss >> limits.movetime; }
+                else if ( token == "nodes" ) { ss >> limits.nodes; }
+                else if ( token == "depth" ) { ss >> limits.depth; }
+                else if ( token == "infinite" ) { limits.infinite = true; }
+                else if ( token == "ponder" ) { limits.ponder = true; }
             }
-            else {
-            here:
-                Move best_move = game.bestMove();
-                std::cout << "bestmove " << best_move.toLongAlgebraic() << '\n';
+
+            if ( perft ) {
+                game.stopSearch();
+                const uint64_t total_nodes = game.perftDetailEntry(limits.depth);
+                std::cout << '\n' << "nodes searched: " << total_nodes << '\n';
+                continue;
             }
+
+            // a plain 'go' searches to the old fixed depth
+            const bool has_limit = limits.wtime || limits.btime || limits.movetime || limits.nodes || limits.depth;
+            if ( !has_limit && !limits.infinite ) {
+                limits.depth = DEFAULT_DEPTH;
+            }
+
+            // the input thread stays free for stop, ponderhit and isready
+            game.startSearch(limits,
+                [this](const SearchInfo& info) { printInfo(info); },
+                [this](const SearchInfo& result) { printBestMove(result); });
         }
         else if ( token == "isready" ) {
-            std::cout << "readyok\n";
+            std::lock_guard<std::mutex> lock(output_mutex);
+            std::cout << "readyok" << std::endl;
         }
         else if ( token == "print" || token == "d" ) {
+            game.stopSearch();
             std::cout << game.toString() << '\n';
         }
         else if ( token == "ucinewgame" ) {
             // do nothing
         }
         else {
-            std::cout << "unknown command: " << token << '\n';
+            // a search may be running and printing on its own thread
+            std::lock_guard<std::mutex> lock(output_mutex);
+            std::cout << "unknown command: " << token << std::endl;
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(int threads)
+{
+    const size_t count = static_cast<size_t>(std::max(threads, 1));
+
+    for ( size_t i = 0; i < count; ++i ) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+
+    for ( size_t i = 0; i < count; ++i ) {
+        workers.emplace_back(&ThreadPool::run, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    work_available.notify_all();
+
+    for ( auto& worker : workers ) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++pending;
+        ++queued;
+
+        Queue& queue = *queues[next_queue++ % queues.size()];
+        std::lock_guard<std::mutex> queue_lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+
+    work_available.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    all_done.wait(lock, [this] { return pending == 0; });
+}
+
+bool ThreadPool::pop(size_t id, Task& task)
+{
+    Queue& queue = *queues[id];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if ( queue.tasks.empty() ) {
+        return false;
+    }
+
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal(size_t id, Task& task)
+{
+    for ( size_t offset = 1; offset < queues.size(); ++offset ) {
+        Queue& queue = *queues[(id + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if ( !queue.tasks.empty() ) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            steal_count.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ThreadPool::run(size_t id)
+{
+    Task task;
+    while ( true ) {
+        if ( pop(id, task) || steal(id, task) ) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --queued;
+            }
+
+            task();
+            task = nullptr;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if ( --pending == 0 ) {
+                all_done.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        work_available.wait(lock, [this] { return stop || queued > 0; });
+        if ( stop && queued == 0 ) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,92 @@
+#include "ttable.h"
+
+#include <cstdio>
+#include <iomanip>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tt_file {
+    void* map(const std::string& path, const TTFileHeader& expected, size_t table_bytes)
+    {
+        const size_t file_bytes = sizeof(TTFileHeader) + table_bytes;
+
+        const int fd = open(path.c_str(), O_RDONLY);
+        if ( fd < 0 ) {
+            return nullptr;
+        }
+
+        struct stat st;
+        TTFileHeader stored;
+        const bool valid = fstat(fd, &st) == 0
+            && static_cast<size_t>(st.st_size) == file_bytes
+            && pread(fd, &stored, sizeof(stored), 0) == static_cast<ssize_t>(sizeof(stored))
+            && stored == expected;
+
+        if ( !valid ) {
+            close(fd);
+            return nullptr;
+        }
+
+        // private mapping: pages are read lazily and our writes never reach the file,
+        // the file is only replaced as a whole by store()
+        void* mapping = mmap(nullptr, file_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd);
+
+        return mapping == MAP_FAILED ? nullptr : mapping;
+    }
+
+    void unmap(void* mapping, size_t table_bytes)
+    {
+        munmap(mapping, sizeof(TTFileHeader) + table_bytes);
+    }
+
+    bool store(const std::string& path, const TTFileHeader& header, const void* table, size_t table_bytes)
+    {
+        const std::string tmp_path = path + ".tmp";
+
+        FILE* file = std::fopen(tmp_path.c_str(), "wb");
+        if ( file == nullptr ) {
+            return false;
+        }
+
+        const bool written = std::fwrite(&header, sizeof(header), 1, file) == 1
+            && std::fwrite(table, table_bytes, 1, file) == 1;
+
+        if ( std::fclose(file) != 0 || !written ) {
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+
+        return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+    }
+}; // namespace tt_file
+
+void TTStats::reset()
+{
+    for ( auto* counter : { &probes, &hits, &collisions, &stores, &replaced_shallower, &replaced_equal, &replaced_deeper } ) {
+        counter->store(0, std::memory_order_relaxed);
+    }
+}
+
+std::ostream& operator<<(std::ostream& os, const TTStats& stats)
+{
+    const auto percent = [](uint64_t part, uint64_t total) {
+        return total == 0 ? 0.0 : 100.0 * static_cast<double>(part) / static_cast<double>(total);
+    };
+
+    const uint64_t probes = stats.probes.load(std::memory_order_relaxed);
+    const uint64_t stores = stats.stores.load(std::memory_order_relaxed);
+
+    os << std::fixed << std::setprecision(1)
+        << "probes " << probes
+        << " hits " << stats.hits << " (" << percent(stats.hits, probes) << "%)"
+        << " collisions " << stats.collisions << " (" << percent(stats.collisions, probes) << "%)"
+        << " stores " << stores
+        << " replaced shallower/equal/deeper " << stats.replaced_shallower
+        << '/' << stats.replaced_equal
+        << '/' << stats.replaced_deeper;
+
+    return os;
+}